@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * alloctrace.c
+ *
+ * The live blocks are kept in an open addressing table keyed by address so
+ * that blocks allocated elsewhere (e.g. by the C library) are freed without
+ * being accounted for.
+ */
+
+#define ALLOC_TRACE_IMPL
+
+#include "alloctrace.h"
+
+#ifdef ALLOC_TRACE
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SITES 1024
+#define INITIAL_BLOCKS 1024
+
+/*
+ * The allocations made at a call site.
+ */
+struct site {
+    const char *file;
+    int line;
+    long allocs;
+    size_t bytes;
+};
+
+/*
+ * A live heap block.
+ */
+struct block {
+    void *address;
+    size_t size;
+};
+
+static struct site sites[MAX_SITES];
+static struct block *blocks;
+static size_t blocks_capacity;
+static size_t blocks_count;
+static long allocs;
+static long frees;
+static size_t bytes;
+static size_t heap;
+static size_t peak;
+static int initialised;
+
+static void report_at_exit()
+{
+    alloc_trace_report(stderr);
+}
+
+static size_t hash_address(void *address)
+{
+    uintptr_t h = (uintptr_t)address;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+static struct site *get_site(const char *file, int line)
+{
+    size_t i = (hash_address((void *)file) + line) % MAX_SITES;
+    for (size_t n = 0; n < MAX_SITES; n++, i = (i + 1) % MAX_SITES) {
+        if (!sites[i].file) {
+            sites[i].file = file;
+            sites[i].line = line;
+        }
+        if (sites[i].file == file && sites[i].line == line)
+            return &sites[i];
+    }
+    /* Account for the rest in the last slot when out of sites */
+    return &sites[MAX_SITES - 1];
+}
+
+static void put_block(void *address, size_t size);
+
+static void grow_blocks()
+{
+    struct block *old_blocks = blocks;
+    size_t old_capacity = blocks_capacity;
+    blocks_capacity = old_capacity ? old_capacity * 2 : INITIAL_BLOCKS;
+    blocks = calloc(blocks_capacity, sizeof(struct block));
+    blocks_count = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_blocks[i].address)
+            put_block(old_blocks[i].address, old_blocks[i].size);
+    }
+    free(old_blocks);
+}
+
+static void put_block(void *address, size_t size)
+{
+    if (2 * (blocks_count + 1) > blocks_capacity)
+        grow_blocks();
+    size_t mask = blocks_capacity - 1;
+    size_t i = hash_address(address) & mask;
+    while (blocks[i].address)
+        i = (i + 1) & mask;
+    blocks[i].address = address;
+    blocks[i].size = size;
+    blocks_count++;
+}
+
+/*
+ * Removes the block at the specified address returning its size or 0 if the
+ * block is not known.
+ */
+static size_t remove_block(void *address)
+{
+    if (!blocks_count)
+        return 0;
+    size_t mask = blocks_capacity - 1;
+    size_t i = hash_address(address) & mask;
+    while (blocks[i].address != address) {
+        if (!blocks[i].address)
+            return 0;
+        i = (i + 1) & mask;
+    }
+    size_t size = blocks[i].size;
+    blocks_count--;
+
+    /* Shift back the following blocks of the cluster to fill the gap */
+    size_t j = i;
+    for (;;) {
+        blocks[i].address = NULL;
+        do {
+            j = (j + 1) & mask;
+            if (!blocks[j].address)
+                return size;
+        } while (((j - (hash_address(blocks[j].address) & mask)) & mask) <
+                ((j - i) & mask));
+        blocks[i] = blocks[j];
+        i = j;
+    }
+}
+
+static void *account(void *address, size_t size, const char *file, int line)
+{
+    if (!address)
+        return NULL;
+    if (!initialised) {
+        initialised = 1;
+        atexit(report_at_exit);
+    }
+    struct site *site = get_site(file, line);
+    site->allocs++;
+    site->bytes += size;
+    allocs++;
+    bytes += size;
+    heap += size;
+    if (heap > peak)
+        peak = heap;
+    put_block(address, size);
+    return address;
+}
+
+void *alloc_trace_malloc(size_t size, const char *file, int line)
+{
+    return account(malloc(size), size, file, line);
+}
+
+void *alloc_trace_calloc(size_t n, size_t size, const char *file, int line)
+{
+    return account(calloc(n, size), n * size, file, line);
+}
+
+void *alloc_trace_realloc(void *p, size_t size, const char *file, int line)
+{
+    size_t old_size = p ? remove_block(p) : 0;
+    void *address = realloc(p, size);
+    if (!address && size) {
+        /* The original block is left intact */
+        if (old_size)
+            put_block(p, old_size);
+        return NULL;
+    }
+    heap -= old_size;
+    if (p)
+        frees++;
+    return account(address, size, file, line);
+}
+
+char *alloc_trace_strdup(const char *s, const char *file, int line)
+{
+    size_t size = strlen(s) + 1;
+    char *address = malloc(size);
+    if (address)
+        memcpy(address, s, size);
+    return account(address, size, file, line);
+}
+
+void alloc_trace_free(void *p)
+{
+    if (p) {
+        heap -= remove_block(p);
+        frees++;
+    }
+    free(p);
+}
+
+long alloc_trace_count()
+{
+    return allocs;
+}
+
+size_t alloc_trace_peak()
+{
+    return peak;
+}
+
+static int compare_sites(const void *a, const void *b)
+{
+    const struct site *x = a;
+    const struct site *y = b;
+    return (x->allocs < y->allocs) - (x->allocs > y->allocs);
+}
+
+void alloc_trace_report(FILE *file)
+{
+    fprintf(file,
+            "Heap allocations: %ld (%zu bytes), frees: %ld, peak heap: %zu "
+            "bytes, live: %zu (%zu bytes)\n",
+            allocs, bytes, frees, peak, blocks_count, heap);
+    struct site sorted[MAX_SITES];
+    memcpy(sorted, sites, sizeof(sites));
+    qsort(sorted, MAX_SITES, sizeof(struct site), compare_sites);
+    fprintf(file, "%10s %12s  %s\n", "allocs", "bytes", "call site");
+    for (int i = 0; i < MAX_SITES && sorted[i].allocs; i++) {
+        fprintf(file, "%10ld %12zu  %s:%d\n", sorted[i].allocs,
+                sorted[i].bytes, sorted[i].file, sorted[i].line);
+    }
+}
+
+#endif /* ALLOC_TRACE */
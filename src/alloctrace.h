@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Heap allocation accounting enabled by building with ALLOC_TRACE defined
+ * (make ALLOC_TRACE=1). The allocation functions are replaced with macros
+ * recording the call site, so this file should be the last one included.
+ */
+
+#ifndef ALLOCTRACE_H_
+#define ALLOCTRACE_H_
+
+#ifdef ALLOC_TRACE
+
+#include <stddef.h>
+#include <stdio.h>
+
+void *alloc_trace_malloc(size_t, const char *, int);
+void *alloc_trace_calloc(size_t, size_t, const char *, int);
+void *alloc_trace_realloc(void *, size_t, const char *, int);
+char *alloc_trace_strdup(const char *, const char *, int);
+void alloc_trace_free(void *);
+
+/*
+ * Returns the number of heap allocations made so far.
+ */
+long alloc_trace_count();
+
+/*
+ * Returns the peak heap usage in bytes.
+ */
+size_t alloc_trace_peak();
+
+/*
+ * Prints out the totals and the allocations per call site. Called at exit
+ * to standard error.
+ */
+void alloc_trace_report(FILE *);
+
+#ifndef ALLOC_TRACE_IMPL
+#define malloc(size) alloc_trace_malloc(size, __FILE__, __LINE__)
+#define calloc(n, size) alloc_trace_calloc(n, size, __FILE__, __LINE__)
+#define realloc(p, size) alloc_trace_realloc(p, size, __FILE__, __LINE__)
+#define strdup(s) alloc_trace_strdup(s, __FILE__, __LINE__)
+#define free(p) alloc_trace_free(p)
+#endif /* ALLOC_TRACE_IMPL */
+
+#endif /* ALLOC_TRACE */
+
+#endif /* ALLOCTRACE_H_ */
@@ -38,22 +38,45 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cmdline.h"
+#include "logger.h"
 #include "utils.h"
+#include "xsystem.h"
+#include "alloctrace.h"
+
+/* The maximum number of jobs run at once */
+#define MAX_JOBS 256
 
 struct config_st {
     int opt_limit;
+    int jobs;
+    int log_level;
     char *workspace_name;
     char *def_file_name;
+    char *metrics_file_name;
+    char *history_file_name;
+    char *journal_dir_name;
+    char *where;
     bool verbose;
     bool colour;
+    bool rebuild_cache;
+    bool resume;
+    enum output_format format;
+    enum spawn_strategy spawn_strategy;
 };
 
 static void reset(config *obj)
 {
     obj->opt_limit = 1;
-    obj->workspace_name = obj->def_file_name = NULL;
+    obj->jobs = 1;
+    obj->log_level = LOGLEVEL_DEFAULT;
+    obj->workspace_name = obj->def_file_name = obj->metrics_file_name = NULL;
+    obj->history_file_name = obj->journal_dir_name = obj->where = NULL;
     obj->verbose = false;
     obj->colour = true;
+    obj->rebuild_cache = false;
+    obj->resume = false;
+    obj->format = FORMAT_TEXT;
+    obj->spawn_strategy = xsystem_get_strategy();
 }
 
 config *config_new()
@@ -81,6 +104,65 @@ static char *parse_def_file_name(config *obj, char *arg)
     return NULL;
 }
 
+static char *parse_metrics_file_name(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    if (!src || !*++src)
+        return "Invalid metrics file option";
+    obj->metrics_file_name = strdup(src);
+    return NULL;
+}
+
+static char *parse_where(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    if (!src || !*++src)
+        return "Invalid where option";
+    obj->where = strdup(src);
+    return NULL;
+}
+
+static char *parse_format(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    if (src && !strcmp(src + 1, "text"))
+        obj->format = FORMAT_TEXT;
+    else if (src && !strcmp(src + 1, "json"))
+        obj->format = FORMAT_JSON;
+    else
+        return "Invalid format option";
+    return NULL;
+}
+
+static char *parse_jobs(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    char *end;
+    long jobs = src ? strtol(++src, &end, 10) : 0;
+    if (!src || !*src || *end || jobs < 1 || jobs > MAX_JOBS)
+        return "Invalid jobs option";
+    obj->jobs = (int)jobs;
+    return NULL;
+}
+
+static char *parse_log_level(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    int level = src ? logger_parse_level(src + 1) : -1;
+    if (level < 0)
+        return "Invalid log level option";
+    obj->log_level = level;
+    return NULL;
+}
+
+static char *parse_spawn_strategy(config *obj, char *arg)
+{
+    char *src = strchr(arg, '=');
+    if (!src || !xsystem_parse_strategy(++src, &obj->spawn_strategy))
+        return "Invalid spawn strategy option";
+    return NULL;
+}
+
 __attribute__((always_inline)) static inline void mark_opt_limit(
         config *obj, int index)
 {
@@ -98,6 +180,24 @@ char *config_parse_cmd_line(config *obj, int argc, char *argv[])
         } else if (equal_opts(argv[i], "--def")) {
             err_msg = parse_def_file_name(obj, argv[i]);
             mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--metrics-file")) {
+            err_msg = parse_metrics_file_name(obj, argv[i]);
+            mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--where")) {
+            err_msg = parse_where(obj, argv[i]);
+            mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--jobs") || equal_opts(argv[i], "-j")) {
+            err_msg = parse_jobs(obj, argv[i]);
+            mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--format")) {
+            err_msg = parse_format(obj, argv[i]);
+            mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--log-level")) {
+            err_msg = parse_log_level(obj, argv[i]);
+            mark_opt_limit(obj, i);
+        } else if (equal_opts(argv[i], "--spawn")) {
+            err_msg = parse_spawn_strategy(obj, argv[i]);
+            mark_opt_limit(obj, i);
         } else if (!strcmp(argv[i], "--verbose") || !strcmp(argv[i], "-v")) {
             obj->verbose = true;
             mark_opt_limit(obj, i);
@@ -105,21 +205,37 @@ char *config_parse_cmd_line(config *obj, int argc, char *argv[])
                 !strcmp(argv[i], "--no-color")) {
             obj->colour = false;
             mark_opt_limit(obj, i);
+        } else if (!strcmp(argv[i], "--rebuild-cache")) {
+            obj->rebuild_cache = true;
+            mark_opt_limit(obj, i);
+        } else if (!strcmp(argv[i], "--resume")) {
+            obj->resume = true;
+            mark_opt_limit(obj, i);
         }
         if (err_msg)
             return err_msg;
     }
 
     /* Default the definition file name to <user_dir>/.octo/workspace */
+    char *homedir = get_home();
+    char tmp[MAX_PATH];
     if (!obj->def_file_name) {
-        char *homedir = get_home();
-        char tmp[MAX_PATH];
         snprintf(tmp, MAX_PATH, "%s%c.octo%cworkspaces", homedir,
                 path_separator(), path_separator());
         obj->def_file_name = strdup(tmp);
-        free(homedir);
     }
 
+    /* The run history is kept in <user_dir>/.octo/history */
+    snprintf(tmp, MAX_PATH, "%s%c.octo%chistory", homedir, path_separator(),
+            path_separator());
+    obj->history_file_name = strdup(tmp);
+
+    /* The journals of the runs are kept in <user_dir>/.octo/journal */
+    snprintf(tmp, MAX_PATH, "%s%c.octo%cjournal", homedir, path_separator(),
+            path_separator());
+    obj->journal_dir_name = strdup(tmp);
+    free(homedir);
+
     return NULL;
 }
 
@@ -128,6 +244,16 @@ int config_get_opt_limit(config *obj)
     return obj->opt_limit;
 }
 
+int config_get_jobs(config *obj)
+{
+    return obj->jobs;
+}
+
+int config_get_log_level(config *obj)
+{
+    return obj->log_level;
+}
+
 char *config_get_workspace_name(config *obj)
 {
     return obj->workspace_name;
@@ -138,6 +264,26 @@ char *config_get_def_file_name(config *obj)
     return obj->def_file_name;
 }
 
+char *config_get_metrics_file_name(config *obj)
+{
+    return obj->metrics_file_name;
+}
+
+char *config_get_history_file_name(config *obj)
+{
+    return obj->history_file_name;
+}
+
+char *config_get_journal_dir_name(config *obj)
+{
+    return obj->journal_dir_name;
+}
+
+char *config_get_where(config *obj)
+{
+    return obj->where;
+}
+
 bool config_is_verbose(config *obj)
 {
     return obj->verbose;
@@ -148,9 +294,33 @@ bool config_is_colour(config *obj)
     return obj->colour;
 }
 
+bool config_is_rebuild_cache(config *obj)
+{
+    return obj->rebuild_cache;
+}
+
+bool config_is_resume(config *obj)
+{
+    return obj->resume;
+}
+
+enum output_format config_get_format(config *obj)
+{
+    return obj->format;
+}
+
+enum spawn_strategy config_get_spawn_strategy(config *obj)
+{
+    return obj->spawn_strategy;
+}
+
 void config_destroy(config *obj)
 {
     free(obj->workspace_name);
     free(obj->def_file_name);
+    free(obj->metrics_file_name);
+    free(obj->history_file_name);
+    free(obj->journal_dir_name);
+    free(obj->where);
     free(obj);
 }
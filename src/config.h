@@ -33,16 +33,32 @@
 #define CONFIG_H_
 
 #include <stdbool.h>
+#include "xsystem.h"
 
 typedef struct config_st config;
 
+/*
+ * Formats of the results printed out.
+ */
+enum output_format { FORMAT_TEXT, FORMAT_JSON };
+
 config *config_new();
 char *config_parse_cmd_line(config *, int, char *[]);
 int config_get_opt_limit(config *);
+int config_get_jobs(config *);
+int config_get_log_level(config *);
 char *config_get_workspace_name(config *);
 char *config_get_def_file_name(config *);
+char *config_get_metrics_file_name(config *);
+char *config_get_history_file_name(config *);
+char *config_get_journal_dir_name(config *);
+char *config_get_where(config *);
 bool config_is_verbose(config *);
 bool config_is_colour(config *);
+bool config_is_rebuild_cache(config *);
+bool config_is_resume(config *);
+enum output_format config_get_format(config *);
+enum spawn_strategy config_get_spawn_strategy(config *);
 void config_destroy(config *);
 
 #endif /* CONFIG_H_ */
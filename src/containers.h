@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Type-specialised containers generated by macros, along the lines of C++
+ * templates. Everything is inline so that the compiler can see through the
+ * loops over the elements instead of calling back through void pointers.
+ *
+ *   DECLARE_VECTOR(int_vector, int)
+ *   struct int_vector v;
+ *   int_vector_init(&v);
+ *   int_vector_push(&v, 42);
+ *   VECTOR_FOREACH(int, i, &v)
+ *       printf("%d\n", *i);
+ *   int_vector_destroy(&v);
+ *
+ * The string maps and sets borrow their keys, which have to outlive them.
+ * Keys are compared by pointer before their characters are, so interned
+ * strings are cheap to look up.
+ */
+
+#ifndef CONTAINERS_H_
+#define CONTAINERS_H_
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONTAINERS_MIN_CAPACITY 8
+
+/* FNV-1a hash of the specified zero-terminated string */
+static inline unsigned str_hash(const char *s)
+{
+    unsigned h = 2166136261u;
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Declares struct name, a growable contiguous array of the specified type,
+ * along with its functions.
+ */
+#define DECLARE_VECTOR(name, type)                                             \
+    struct name {                                                              \
+        type *items;                                                           \
+        int size;                                                              \
+        int capacity;                                                          \
+    };                                                                         \
+                                                                               \
+    static inline void name##_init(struct name *v)                             \
+    {                                                                          \
+        v->items = NULL;                                                       \
+        v->size = v->capacity = 0;                                             \
+    }                                                                          \
+                                                                               \
+    /* Makes room for the specified number of items */                         \
+    static inline bool name##_reserve(struct name *v, int capacity)            \
+    {                                                                          \
+        if (capacity <= v->capacity)                                           \
+            return true;                                                       \
+        type *items = realloc(v->items, capacity * sizeof(type));              \
+        if (!items)                                                            \
+            return false;                                                      \
+        v->items = items;                                                      \
+        v->capacity = capacity;                                                \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline bool name##_push(struct name *v, type item)                  \
+    {                                                                          \
+        if (v->size == v->capacity &&                                          \
+                !name##_reserve(v, v->capacity ? 2 * v->capacity               \
+                                               : CONTAINERS_MIN_CAPACITY))     \
+            return false;                                                      \
+        v->items[v->size++] = item;                                            \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    /* Appends the specified number of items, doubling the capacity */         \
+    static inline bool name##_append(                                          \
+            struct name *v, const type *items, int count)                      \
+    {                                                                          \
+        if (v->size + count > v->capacity) {                                   \
+            int capacity =                                                     \
+                    v->capacity ? 2 * v->capacity : CONTAINERS_MIN_CAPACITY;   \
+            while (capacity < v->size + count)                                 \
+                capacity *= 2;                                                 \
+            if (!name##_reserve(v, capacity))                                  \
+                return false;                                                  \
+        }                                                                      \
+        if (count)                                                             \
+            memcpy(v->items + v->size, items, count * sizeof(type));           \
+        v->size += count;                                                      \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline type name##_get(const struct name *v, int i)                 \
+    {                                                                          \
+        return v->items[i];                                                    \
+    }                                                                          \
+                                                                               \
+    /* Removes the last item, the vector must not be empty */                  \
+    static inline type name##_pop(struct name *v)                              \
+    {                                                                          \
+        return v->items[--v->size];                                            \
+    }                                                                          \
+                                                                               \
+    static inline int name##_size(const struct name *v)                        \
+    {                                                                          \
+        return v->size;                                                        \
+    }                                                                          \
+                                                                               \
+    /* Initialises the destination vector with a copy of the source */         \
+    static inline bool name##_clone(struct name *dst, const struct name *src)  \
+    {                                                                          \
+        name##_init(dst);                                                      \
+        if (!name##_reserve(dst, src->size))                                   \
+            return false;                                                      \
+        if (src->size)                                                         \
+            memcpy(dst->items, src->items, src->size * sizeof(type));          \
+        dst->size = src->size;                                                 \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline void name##_clear(struct name *v)                            \
+    {                                                                          \
+        v->size = 0;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline void name##_destroy(struct name *v)                          \
+    {                                                                          \
+        free(v->items);                                                        \
+        name##_init(v);                                                        \
+    }
+
+/*
+ * Iterates over the items of the vector with var pointing to each in turn.
+ */
+#define VECTOR_FOREACH(type, var, v)                                           \
+    for (type *var = (v)->items; var < (v)->items + (v)->size; var++)
+
+/*
+ * Declares struct name, a hash map of borrowed string keys to the values of
+ * the specified type, along with its functions. The slots are probed
+ * linearly and keep the full hashes of their keys.
+ */
+#define DECLARE_STR_MAP(name, type)                                            \
+    struct name##_slot {                                                       \
+        const char *key;                                                       \
+        unsigned hash;                                                         \
+        type value;                                                            \
+    };                                                                         \
+                                                                               \
+    struct name {                                                              \
+        struct name##_slot *slots;                                             \
+        int size;                                                              \
+        /* The number of slots, zero or a power of two */                      \
+        int capacity;                                                          \
+    };                                                                         \
+                                                                               \
+    static inline void name##_init(struct name *m)                             \
+    {                                                                          \
+        m->slots = NULL;                                                       \
+        m->size = m->capacity = 0;                                             \
+    }                                                                          \
+                                                                               \
+    /* Returns the slot holding the key or the empty one it would go to */     \
+    static inline struct name##_slot *name##_probe(                            \
+            const struct name *m, const char *key, unsigned hash)              \
+    {                                                                          \
+        int mask = m->capacity - 1;                                            \
+        struct name##_slot *slot = &m->slots[hash & mask];                     \
+        while (slot->key && (slot->hash != hash ||                             \
+                                    (slot->key != key &&                       \
+                                            strcmp(slot->key, key))))          \
+            slot = &m->slots[(slot - m->slots + 1) & mask];                    \
+        return slot;                                                           \
+    }                                                                          \
+                                                                               \
+    /* Returns the value mapped to the key or NULL if there is none */         \
+    static inline type *name##_get(const struct name *m, const char *key)      \
+    {                                                                          \
+        if (!m->size)                                                          \
+            return NULL;                                                       \
+        struct name##_slot *slot = name##_probe(m, key, str_hash(key));        \
+        return slot->key ? &slot->value : NULL;                                \
+    }                                                                          \
+                                                                               \
+    static inline bool name##_grow(struct name *m)                             \
+    {                                                                          \
+        struct name##_slot *old_slots = m->slots;                              \
+        int old_capacity = m->capacity;                                        \
+        int capacity = old_capacity ? 2 * old_capacity                         \
+                                    : CONTAINERS_MIN_CAPACITY;                 \
+        m->slots = calloc(capacity, sizeof(struct name##_slot));               \
+        if (!m->slots) {                                                       \
+            m->slots = old_slots;                                              \
+            return false;                                                      \
+        }                                                                      \
+        m->capacity = capacity;                                                \
+        for (int i = 0; i < old_capacity; i++) {                               \
+            if (old_slots[i].key)                                              \
+                *name##_probe(m, old_slots[i].key, old_slots[i].hash) =        \
+                        old_slots[i];                                          \
+        }                                                                      \
+        free(old_slots);                                                       \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    /* Maps the key to the value replacing the previous mapping if any */      \
+    static inline bool name##_put(                                             \
+            struct name *m, const char *key, type value)                       \
+    {                                                                          \
+        /* Keep the load factor at or below 3/4 */                             \
+        if (4 * (m->size + 1) > 3 * m->capacity && !name##_grow(m))            \
+            return false;                                                      \
+        unsigned hash = str_hash(key);                                         \
+        struct name##_slot *slot = name##_probe(m, key, hash);                 \
+        if (!slot->key) {                                                      \
+            slot->key = key;                                                   \
+            slot->hash = hash;                                                 \
+            m->size++;                                                         \
+        }                                                                      \
+        slot->value = value;                                                   \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline int name##_size(const struct name *m)                        \
+    {                                                                          \
+        return m->size;                                                        \
+    }                                                                          \
+                                                                               \
+    static inline void name##_destroy(struct name *m)                          \
+    {                                                                          \
+        free(m->slots);                                                        \
+        name##_init(m);                                                        \
+    }
+
+/*
+ * Iterates over the occupied slots of the string map with var pointing to
+ * each in turn. The order is unspecified.
+ */
+#define STR_MAP_FOREACH(name, var, m)                                          \
+    for (struct name##_slot *var = (m)->slots;                                 \
+            var < (m)->slots + (m)->capacity; var++)                           \
+        if (!var->key) {                                                       \
+        } else
+
+/*
+ * Sets of up to this many strings are searched linearly, larger ones are
+ * indexed by a hash map.
+ */
+#define STR_SET_INDEX_THRESHOLD 16
+
+/*
+ * Declares struct name, an insertion-ordered set of borrowed strings, along
+ * with its functions. Small sets are kept as a plain array; the hashed index
+ * is only built once the set outgrows STR_SET_INDEX_THRESHOLD.
+ */
+#define DECLARE_STR_SET(name)                                                  \
+    DECLARE_VECTOR(name##_keys, const char *)                                  \
+    DECLARE_STR_MAP(name##_index, int)                                         \
+                                                                               \
+    struct name {                                                              \
+        struct name##_keys keys;                                               \
+        struct name##_index index;                                             \
+    };                                                                         \
+                                                                               \
+    static inline void name##_init(struct name *s)                             \
+    {                                                                          \
+        name##_keys_init(&s->keys);                                            \
+        name##_index_init(&s->index);                                          \
+    }                                                                          \
+                                                                               \
+    static inline bool name##_contains(const struct name *s, const char *key)  \
+    {                                                                          \
+        if (s->index.capacity)                                                 \
+            return name##_index_get(&s->index, key) != NULL;                   \
+        VECTOR_FOREACH(const char *, k, &s->keys) {                            \
+            if (*k == key || !strcmp(*k, key))                                 \
+                return true;                                                   \
+        }                                                                      \
+        return false;                                                          \
+    }                                                                          \
+                                                                               \
+    /* Indexes the keys, leaving the set unindexed if out of memory */         \
+    static inline void name##_build_index(struct name *s)                      \
+    {                                                                          \
+        for (int i = 0; i < s->keys.size; i++) {                               \
+            if (!name##_index_put(&s->index, s->keys.items[i], i)) {           \
+                name##_index_destroy(&s->index);                               \
+                return;                                                        \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    /* Adds the key unless already present. Returns true if it was added */    \
+    static inline bool name##_add(struct name *s, const char *key)             \
+    {                                                                          \
+        if (name##_contains(s, key) || !name##_keys_push(&s->keys, key))       \
+            return false;                                                      \
+        if (s->index.capacity) {                                               \
+            if (!name##_index_put(&s->index, key, s->keys.size - 1)) {         \
+                name##_keys_pop(&s->keys);                                     \
+                return false;                                                  \
+            }                                                                  \
+        } else if (s->keys.size > STR_SET_INDEX_THRESHOLD)                     \
+            name##_build_index(s);                                             \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline const char *name##_get(const struct name *s, int i)          \
+    {                                                                          \
+        return s->keys.items[i];                                               \
+    }                                                                          \
+                                                                               \
+    static inline int name##_size(const struct name *s)                        \
+    {                                                                          \
+        return s->keys.size;                                                   \
+    }                                                                          \
+                                                                               \
+    static inline void name##_destroy(struct name *s)                          \
+    {                                                                          \
+        name##_keys_destroy(&s->keys);                                         \
+        name##_index_destroy(&s->index);                                       \
+    }
+
+/*
+ * Iterates over the keys of the string set in the order they were added with
+ * var pointing to each in turn.
+ */
+#define STR_SET_FOREACH(var, s) VECTOR_FOREACH(const char *, var, &(s)->keys)
+
+#endif /* CONTAINERS_H_ */
@@ -32,11 +32,18 @@
 #ifndef DCONSUMER_H_
 #define DCONSUMER_H_
 
+#include <stddef.h>
+
+/*
+ * Receiver of the declarations. The names are passed along with their
+ * lengths as they are not zero-terminated.
+ */
 struct dconsumer {
     void *instance;
-    void (*add_project)(void *, const char *);
-    void (*add_workspace)(void *, const char *, const char *);
-    void (*add_workspace_project)(void *, const char *, const char *);
+    void (*add_project)(void *, const char *, size_t);
+    void (*add_workspace)(void *, const char *, size_t, const char *, size_t);
+    void (*add_workspace_project)(
+            void *, const char *, size_t, const char *, size_t);
 };
 
 #endif /* DCONSUMER_H_ */
@@ -37,10 +37,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "containers.h"
 #include "dconsumer.h"
 #include "logger.h"
-
-#define BUFFER_SIZE 1024
+#include "alloctrace.h"
 
 /*
  * TODO Implement error detection and handling.
@@ -69,17 +69,24 @@ enum mode {
     W_ALIAS,
     W_POINTER,
     W_PATH,
-    W_TUPLE
+    W_TUPLE,
+    /* In the block of a workspace filtered out */
+    W_SKIP
 };
 
 /*
- * Grammatic token structure.
+ * Character classes. The bytes outside of the printable ASCII range, but the
+ * tab and the line feed, are ignored without ending the token.
  */
-struct token {
-    char buffer[BUFFER_SIZE];
-    int pos;
-    int capacity;
-};
+enum char_class { TOKEN_CHAR, BLANK, NEW_LINE, OPEN, CLOSE, HASH, IGNORED };
+
+static unsigned char char_classes[256];
+
+/*
+ * Growable text buffer holding the characters that have to outlive the
+ * chunk they came in.
+ */
+DECLARE_VECTOR(text, char)
 
 /*
  * Parser state.
@@ -88,43 +95,63 @@ struct dparser_st {
     logger *logger;
     enum parsing_state parsing_state;
     enum mode mode;
-    struct token token;
-    struct token token2;
+    /* The start of the token spanning more than one chunk */
+    struct text carry;
+    /* The alias of the workspace being declared */
+    struct text alias;
+    /* The only workspace passed to the consumer or NULL */
+    const char *workspace_filter;
+    /* Whether the workspace being declared is filtered out */
+    bool skipping;
+    bool stopped;
     const struct dconsumer *dconsumer;
     const char *err_msg;
 };
 
+static void init_char_classes()
+{
+    static bool initialised = false;
+    if (initialised)
+        return;
+    initialised = true;
+    for (int c = 0; c < 256; c++)
+        char_classes[c] = c < 0x20 || c > 0x7E ? IGNORED : TOKEN_CHAR;
+    char_classes[' '] = BLANK;
+    char_classes['\t'] = BLANK;
+    char_classes['\n'] = NEW_LINE;
+    char_classes['{'] = OPEN;
+    char_classes['}'] = CLOSE;
+    char_classes['#'] = HASH;
+}
+
 dparser *dpaser_new(logger *logger, const struct dconsumer *dconsumer)
 {
-    dparser *obj = (dparser *)malloc(sizeof(struct dparser_st));
     if (!logger)
         return NULL;
+    init_char_classes();
+    dparser *obj = (dparser *)malloc(sizeof(struct dparser_st));
     obj->logger = logger;
     obj->parsing_state = IDLE;
     obj->mode = CONTROL;
+    text_init(&obj->carry);
+    text_init(&obj->alias);
+    obj->workspace_filter = NULL;
+    obj->skipping = false;
+    obj->stopped = false;
     obj->dconsumer = dconsumer;
     obj->err_msg = NULL;
     return obj;
 }
 
-/*
- * Puts the zero character terminator at the end of the token buffer for
- * convenience.
- */
-static void put_terminator(struct token *t)
+static inline bool token_equals(const char *s, size_t len, const char *spec)
 {
-    int index = t->pos >= BUFFER_SIZE ? BUFFER_SIZE - 1 : t->pos;
-    t->buffer[index] = 0;
+    return len == strlen(spec) && !memcmp(s, spec, len);
 }
 
-static const char *finalise_token(dparser *obj)
+static const char *finalise_token(dparser *obj, const char *s, size_t len)
 {
     const char *err_msg = NULL;
-    /*
-     * Zero-terminate the token buffer so that we can pass into various
-     * call back functions.
-     */
-    put_terminator(&obj->token);
+    const struct dconsumer *dconsumer = obj->dconsumer;
 
     switch (obj->mode) {
     case CONTROL:
@@ -132,30 +159,32 @@ static const char *finalise_token(dparser *obj)
          * If we are in the CONTROL mode and we have just seen the projects
          * specifier, switch to the projects tuple mode.
          */
-        if (!strcmp(obj->token.buffer, SPEC_PROJECTS)) {
+        if (token_equals(s, len, SPEC_PROJECTS)) {
             obj->mode = PROJ;
-            DEBUG_LOG(obj->logger, "proj_token: %s\n", obj->token.buffer);
-        } else if (!strcmp(obj->token.buffer, SPEC_WORKSPACE)) {
+            DEBUG_LOG(obj->logger, "proj_token: %.*s\n", (int)len, s);
+        } else if (token_equals(s, len, SPEC_WORKSPACE)) {
             obj->mode = WORKSPACE;
-            DEBUG_LOG(obj->logger, "w_token: %s\n", obj->token.buffer);
+            DEBUG_LOG(obj->logger, "w_token: %.*s\n", (int)len, s);
         }
         break;
     case PROJ_TUPLE:
         /* Notify the consumer of this generic project declaration */
-        obj->dconsumer->add_project(
-                obj->dconsumer->instance, obj->token.buffer);
+        dconsumer->add_project(dconsumer->instance, s, len);
         break;
     case WORKSPACE:
         obj->mode = W_ALIAS;
-        /* Copy this token to the secondary slot which we will need when
-         * we deliver the workspace notification to the consumer interface.
+        /* Keep the alias which we will need when we deliver the workspace
+         * notification to the consumer interface.
          */
-        strcpy(obj->token2.buffer, obj->token.buffer);
-        obj->token2.pos = obj->token.pos;
-        DEBUG_LOG(obj->logger, "w_alias: %s\n", obj->token.buffer);
+        text_clear(&obj->alias);
+        if (!text_append(&obj->alias, s, len))
+            err_msg = "Out of memory";
+        obj->skipping = obj->workspace_filter &&
+                !token_equals(s, len, obj->workspace_filter);
+        DEBUG_LOG(obj->logger, "w_alias: %.*s\n", (int)len, s);
         break;
     case W_ALIAS:
-        if (!strcmp(obj->token.buffer, OP_POINTER)) {
+        if (token_equals(s, len, OP_POINTER)) {
             obj->mode = W_POINTER;
             DEBUG_LOG(obj->logger, "Found a workspace pointer\n");
         } else {
@@ -165,14 +194,16 @@ static const char *finalise_token(dparser *obj)
     case W_POINTER:
         obj->mode = W_PATH;
         /* Notify the consumer of this workspace declaration. */
-        obj->dconsumer->add_workspace(obj->dconsumer->instance,
-                obj->token2.buffer, obj->token.buffer);
-        DEBUG_LOG(obj->logger, "w_path: %s\n", obj->token.buffer);
+        if (!obj->skipping) {
+            dconsumer->add_workspace(dconsumer->instance, obj->alias.items,
+                    obj->alias.size, s, len);
+        }
+        DEBUG_LOG(obj->logger, "w_path: %.*s\n", (int)len, s);
         break;
     case W_TUPLE:
         /* Notify the consumer of this workspace project declaration */
-        obj->dconsumer->add_workspace_project(obj->dconsumer->instance,
-                obj->token2.buffer, obj->token.buffer);
+        dconsumer->add_workspace_project(dconsumer->instance,
+                obj->alias.items, obj->alias.size, s, len);
         break;
 
     default:
@@ -180,83 +211,160 @@ static const char *finalise_token(dparser *obj)
     }
 
     /* Print out the token for debugging purposes */
-    DEBUG_LOG(obj->logger, "Token: %s\n", obj->token.buffer);
+    DEBUG_LOG(obj->logger, "Token: %.*s\n", (int)len, s);
     return err_msg;
 }
 
-const char *dparser_proc_char(dparser *obj, int c)
+/*
+ * Handles the specified delimiter character outside of a token.
+ */
+static const char *proc_delimiter(dparser *obj, enum char_class c)
 {
-    const char *err_msg = NULL;
-
-    if (obj->parsing_state == COMMENT) {
-        if (c == '\n')
-            obj->parsing_state = IDLE;
-        return NULL;
-    }
-
     switch (c) {
-    case ' ':
-    case '\t':
-        if (obj->parsing_state == TOKEN) {
-            obj->parsing_state = IDLE;
-            err_msg = finalise_token(obj);
-        }
-        break;
-    case '#':
-        /* If we are on the new line and we see the comment character,
-         * enter the COMMENT state.
-         */
-        if (obj->parsing_state == IDLE) {
-            obj->parsing_state = COMMENT;
-            DEBUG_LOG(obj->logger, "Found a new comment\n");
-        }
+    case HASH:
+        obj->parsing_state = COMMENT;
+        DEBUG_LOG(obj->logger, "Found a new comment\n");
         break;
-    case '\n':
-        if (obj->parsing_state == TOKEN)
-            err_msg = finalise_token(obj);
-        obj->parsing_state = IDLE;
-        break;
-    case '{':
-        if (obj->parsing_state == TOKEN) {
-            if (finalise_token(obj))
-                break;
-        }
+    case OPEN:
         switch (obj->mode) {
         case PROJ:
             obj->mode = PROJ_TUPLE;
             DEBUG_LOG(obj->logger, "Entered PROJ_TUPLE mode...\n");
             break;
         case W_PATH:
-            obj->mode = W_TUPLE;
+            obj->mode = obj->skipping ? W_SKIP : W_TUPLE;
             DEBUG_LOG(obj->logger, "Entered W_TUPLE mode...\n");
             break;
         default:
-            err_msg = "Encountered a block of unknown type";
-            break;
+            return "Encountered a block of unknown type";
         }
         break;
-    case '}':
-        if (obj->parsing_state == TOKEN)
-            err_msg = finalise_token(obj);
+    case CLOSE:
         /* We are definitely back to CONTROL mode */
         obj->mode = CONTROL;
         break;
     default:
-        if (c >= 0x20 && c <= 0x7E) {
-            if (obj->parsing_state == IDLE) {
+        break;
+    }
+    return NULL;
+}
+
+/*
+ * Skips the block of a workspace filtered out without tokenising it, only
+ * looking for its end and for the comments, which may contain a '}'.
+ * Returns the position to continue from.
+ */
+static const unsigned char *skip_block(
+        dparser *obj, const unsigned char *p, const unsigned char *end)
+{
+    for (; p < end; p++) {
+        enum char_class c = char_classes[*p];
+        if (c == IGNORED)
+            continue;
+        if (c == CLOSE) {
+            obj->mode = CONTROL;
+            obj->parsing_state = IDLE;
+            return p + 1;
+        }
+        if (c == HASH && obj->parsing_state != TOKEN) {
+            obj->parsing_state = COMMENT;
+            return p + 1;
+        }
+        obj->parsing_state = c == TOKEN_CHAR || c == HASH ? TOKEN : IDLE;
+    }
+    return p;
+}
+
+void dparser_set_workspace_filter(dparser *obj, const char *alias)
+{
+    obj->workspace_filter = alias;
+}
+
+void dparser_stop(dparser *obj)
+{
+    obj->stopped = true;
+}
+
+bool dparser_is_stopped(dparser *obj)
+{
+    return obj->stopped;
+}
+
+const char *dparser_proc_buffer(dparser *obj, const char *buffer, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)buffer;
+    const unsigned char *end = p + len;
+    const char *err_msg = NULL;
+
+    while (p < end && !err_msg && !obj->stopped) {
+        if (obj->parsing_state == COMMENT) {
+            /* Skip to the end of the line */
+            p = memchr(p, '\n', end - p);
+            if (!p)
+                break;
+            obj->parsing_state = IDLE;
+            p++;
+            continue;
+        }
+        if (obj->mode == W_SKIP) {
+            p = skip_block(obj, p, end);
+            continue;
+        }
+
+        /* Scan the token */
+        const unsigned char *start = p;
+        while (p < end && char_classes[*p] == TOKEN_CHAR)
+            p++;
+        if (p < end && (char_classes[*p] == IGNORED ||
+                               (char_classes[*p] == HASH &&
+                                       (p > start ||
+                                               obj->parsing_state == TOKEN)))) {
+            /*
+             * Drop the character, a '#' only starts a comment between
+             * tokens. The token is no longer contiguous, so carry it over.
+             */
+            if (p > start) {
                 obj->parsing_state = TOKEN;
-                obj->token.pos = 0;
-                DEBUG_LOG(obj->logger, "Found a new token\n");
+                if (!text_append(&obj->carry, (const char *)start, p - start))
+                    err_msg = "Out of memory";
             }
-            if (obj->parsing_state == TOKEN)
-                obj->token.buffer[obj->token.pos++] = (char)c;
+            p++;
+            continue;
         }
-        break;
+        if (p == end) {
+            /* The token may continue in the next chunk */
+            if (p > start) {
+                obj->parsing_state = TOKEN;
+                if (!text_append(&obj->carry, (const char *)start, p - start))
+                    err_msg = "Out of memory";
+            }
+            break;
+        }
+        if (obj->parsing_state == TOKEN) {
+            /* Complete the token carried over from the previous chunks */
+            obj->parsing_state = IDLE;
+            if (!text_append(&obj->carry, (const char *)start, p - start))
+                return "Out of memory";
+            err_msg = finalise_token(obj, obj->carry.items, obj->carry.size);
+            text_clear(&obj->carry);
+        } else if (p > start)
+            err_msg = finalise_token(
+                    obj, (const char *)start, (size_t)(p - start));
+        if (!err_msg)
+            err_msg = proc_delimiter(obj, char_classes[*p++]);
     }
     return err_msg;
 }
 
+const char *dparser_proc_char(dparser *obj, int c)
+{
+    char ch = (char)c;
+    return dparser_proc_buffer(obj, &ch, 1);
+}
+
 void dparser_destroy(dparser *obj)
 {
+    text_destroy(&obj->carry);
+    text_destroy(&obj->alias);
     free(obj);
 }
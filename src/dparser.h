@@ -34,13 +34,44 @@
 #ifndef DPARSER_H_
 #define DPARSER_H_
 
+#include <stdbool.h>
+#include <stddef.h>
 #include "dconsumer.h"
 #include "logger.h"
 
 typedef struct dparser_st dparser;
 
 dparser *dpaser_new(logger *, const struct dconsumer *);
+
+/*
+ * Restricts the workspace declarations passed to the consumer to those of
+ * the workspace with the specified alias, or lifts the restriction if NULL.
+ * The blocks of the other workspaces are skipped without being tokenised.
+ * The alias has to outlive the parser.
+ */
+void dparser_set_workspace_filter(dparser *, const char *);
+
+/*
+ * Stops the parser, which ignores the rest of the stream. The consumer may
+ * call it once it has seen enough.
+ */
+void dparser_stop(dparser *);
+
+bool dparser_is_stopped(dparser *);
+
+/*
+ * Parses the next chunk of the declaration stream. The tokens are passed to
+ * the consumer as slices of the chunk where possible, so they are only valid
+ * during the call. A token cut by the end of the chunk is carried over to the
+ * next one. Returns the error message or NULL if the chunk is well-formed.
+ */
+const char *dparser_proc_buffer(dparser *, const char *, size_t);
+
+/*
+ * Parses the next character of the declaration stream.
+ */
 const char *dparser_proc_char(dparser *, int);
+
 void dparser_destroy(dparser *);
 
 #endif /* DPARSER_H_ */
@@ -33,13 +33,13 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "alloctrace.h"
 
-#define TMP_BUFFER_SIZE 1024
+#define ERR_MSG_LEN 1024
 
 struct err_publisher_st {
     void *err_handler_inst;
     void (*handle_err)(void *, int, const char *);
-    char *tmp_buffer;
 };
 
 err_publisher *err_publisher_new(
@@ -50,7 +50,6 @@ err_publisher *err_publisher_new(
     err_publisher *obj = malloc(sizeof(struct err_publisher_st));
     obj->err_handler_inst = err_handler_inst;
     obj->handle_err = handle_err;
-    obj->tmp_buffer = malloc(TMP_BUFFER_SIZE);
     return obj;
 }
 
@@ -58,15 +57,17 @@ void err_publisher_fire(err_publisher *obj, int err_code, const char *fmt, ...)
 {
     if (!obj->handle_err)
         return;
+    /* The message is formatted on the stack of the caller so that the
+     * publisher may be fired from several jobs at once */
+    char err_msg[ERR_MSG_LEN];
     va_list args;
     va_start(args, fmt);
-    vsnprintf(obj->tmp_buffer, TMP_BUFFER_SIZE, fmt, args);
+    vsnprintf(err_msg, ERR_MSG_LEN, fmt, args);
     va_end(args);
-    obj->handle_err(obj->err_handler_inst, err_code, obj->tmp_buffer);
+    obj->handle_err(obj->err_handler_inst, err_code, err_msg);
 }
 
 void err_publisher_destroy(err_publisher *obj)
 {
-    free(obj->tmp_buffer);
     free(obj);
 }
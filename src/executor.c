@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * executor.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "executor.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "containers.h"
+#include "progress.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+#define READ_CHUNK_LEN 65536
+#define LABEL_LEN 128
+
+DECLARE_VECTOR(text, char)
+
+/*
+ * The result passed from a job process, followed by the branch name (unless
+ * the length is negative), the output and the error terminated by a null
+ * character (unless the length is zero).
+ */
+struct result_msg {
+    int exit_code;
+    int dirty;
+    int ahead;
+    int behind;
+    long long duration_ns;
+    long long bytes;
+    int branch_len;
+    int output_len;
+    int output_truncated;
+    int error_len;
+};
+
+/*
+ * A job in flight.
+ */
+struct slot {
+    pid_t pid;
+    int job;
+    int out_fd;
+    int result_fd;
+    struct text output;
+};
+
+struct executor_st {
+    plan *plan;
+    struct executor_options options;
+    progress *progress;
+    struct slot *slots;
+    int running;
+    /* The outputs of the jobs done, kept till those before them are done
+     * unless the progress is displayed */
+    struct text *outputs;
+    bool *done;
+    int next_output;
+    int last_workspace;
+    /* The record printed out for a job */
+    struct text record;
+    /* The write end of the result pipe in a job process */
+    int result_fd;
+};
+
+executor *executor_new(plan *plan, const struct executor_options *options)
+{
+    executor *obj = malloc(sizeof(struct executor_st));
+    int size = plan_get_size(plan);
+    obj->plan = plan;
+    obj->options = *options;
+    if (obj->options.concurrency < 1)
+        obj->options.concurrency = 1;
+    obj->progress = options->progress ? progress_new(STDOUT_FILENO, size,
+                                                obj->options.concurrency)
+                                      : NULL;
+    obj->slots = malloc(obj->options.concurrency * sizeof(struct slot));
+    obj->running = 0;
+    obj->outputs = calloc(size ? size : 1, sizeof(struct text));
+    obj->done = calloc(size ? size : 1, sizeof(bool));
+    obj->next_output = 0;
+    obj->last_workspace = -1;
+    text_init(&obj->record);
+    obj->result_fd = -1;
+    return obj;
+}
+
+void executor_expect(executor *obj, int job, long long ns)
+{
+    if (obj->progress)
+        progress_expect(obj->progress, job, ns);
+}
+
+/*
+ * Passes the result of the job to the executing process.
+ */
+static void report_result(void *inst, const struct proc_result *result)
+{
+    executor *obj = inst;
+    struct result_msg msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.exit_code = result->exit_code;
+    msg.dirty = result->dirty;
+    msg.ahead = result->ahead;
+    msg.behind = result->behind;
+    msg.duration_ns = result->duration_ns;
+    msg.bytes = result->bytes;
+    msg.branch_len = result->branch ? (int)strlen(result->branch) : -1;
+    msg.output_len = result->output ? result->output_len : 0;
+    msg.output_truncated = result->output_truncated;
+    msg.error_len = result->error ? (int)strlen(result->error) + 1 : 0;
+    write_fully(obj->result_fd, &msg, sizeof(msg));
+    if (result->branch)
+        write_fully(obj->result_fd, result->branch, msg.branch_len);
+    write_fully(obj->result_fd, result->output, msg.output_len);
+    write_fully(obj->result_fd, result->error, msg.error_len);
+}
+
+/*
+ * Aborts the job, the error message becomes a part of its output.
+ */
+static void handle_job_error(void *inst, int err_code, const char *err_msg)
+{
+    (void)inst; /* unused parameter */
+    (void)err_code; /* unused parameter */
+    printf("Error: %s\n", err_msg);
+    fflush(stdout);
+    _exit(EXIT_FAILURE);
+}
+
+/*
+ * Takes the action on the job in this (child) process with its output going
+ * to the output pipe.
+ */
+static void run_job(executor *obj, proc *proc, int job, int out_fd)
+{
+    dup2(out_fd, STDOUT_FILENO);
+    dup2(out_fd, STDERR_FILENO);
+    close(out_fd);
+    proc_set_err_handler(proc, obj, handle_job_error);
+    proc_set_result_handler(proc, obj, report_result);
+    int w = plan_get_workspace(obj->plan, job);
+    proc_action(proc, plan_get_workspace_path(obj->plan, w),
+            plan_get_project(obj->plan, job),
+            plan_get_project_path(obj->plan, job));
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
+
+static bool start_job(executor *obj, proc *proc, int job)
+{
+    int out[2];
+    int result[2];
+    if (pipe(out))
+        return false;
+    if (pipe(result)) {
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+    /* Do not let the job process print out what is buffered here */
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (!pid) {
+        close(out[0]);
+        close(result[0]);
+        fcntl(result[1], F_SETFD, FD_CLOEXEC);
+        obj->result_fd = result[1];
+        run_job(obj, proc, job, out[1]);
+    }
+    close(out[1]);
+    close(result[1]);
+    if (pid < 0) {
+        close(out[0]);
+        close(result[0]);
+        return false;
+    }
+    /* The commands the job runs need not inherit the read ends */
+    fcntl(out[0], F_SETFD, FD_CLOEXEC);
+    fcntl(result[0], F_SETFD, FD_CLOEXEC);
+
+    struct slot *slot = &obj->slots[obj->running++];
+    slot->pid = pid;
+    slot->job = job;
+    slot->out_fd = out[0];
+    slot->result_fd = result[0];
+    text_init(&slot->output);
+    if (obj->progress) {
+        char label[LABEL_LEN];
+        snprintf(label, LABEL_LEN, "%s/%s",
+                plan_get_workspace_name(
+                        obj->plan, plan_get_workspace(obj->plan, job)),
+                plan_get_project(obj->plan, job));
+        progress_start(obj->progress, job, label, clock_ns());
+    }
+    return true;
+}
+
+/*
+ * Reads what is available from the output of the job. Returns false at the
+ * end of it.
+ */
+static bool read_output(struct slot *slot)
+{
+    struct text *t = &slot->output;
+    if (t->capacity - t->size < READ_CHUNK_LEN &&
+            !text_reserve(t, t->size + (t->size > READ_CHUNK_LEN
+                                                ? t->size
+                                                : READ_CHUNK_LEN)))
+        return false;
+    ssize_t n;
+    do
+        n = read(slot->out_fd, t->items + t->size, t->capacity - t->size);
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+        return false;
+    t->size += n;
+    return true;
+}
+
+/*
+ * Reads the result the job process passed. Returns false if there is none.
+ */
+static bool read_result(executor *obj, proc *proc, struct slot *slot,
+        struct text *msg_text, char *branch, struct proc_result *result)
+{
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(slot->result_fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0 && errno != EINTR)
+            break;
+        if (n > 0 && !text_append(msg_text, buffer, n))
+            return false;
+    }
+    struct result_msg msg;
+    if (msg_text->size < (int)sizeof(msg))
+        return false;
+    memcpy(&msg, msg_text->items, sizeof(msg));
+    int branch_len = msg.branch_len < 0 ? 0 : msg.branch_len;
+    if (branch_len >= MAX_PATH || msg.output_len < 0 || msg.error_len < 0 ||
+            msg_text->size != (int)sizeof(msg) + branch_len + msg.output_len +
+                            msg.error_len)
+        return false;
+
+    int w = plan_get_workspace(obj->plan, slot->job);
+    result->action = proc_get_action(proc);
+    result->path = plan_get_workspace_path(obj->plan, w);
+    result->project = plan_get_project(obj->plan, slot->job);
+    result->project_path = plan_get_project_path(obj->plan, slot->job);
+    result->exit_code = msg.exit_code;
+    result->dirty = msg.dirty;
+    result->ahead = msg.ahead;
+    result->behind = msg.behind;
+    result->duration_ns = msg.duration_ns;
+    result->bytes = msg.bytes;
+    result->branch = NULL;
+    if (msg.branch_len >= 0) {
+        memcpy(branch, msg_text->items + sizeof(msg), branch_len);
+        branch[branch_len] = 0;
+        result->branch = branch;
+    }
+    result->output = msg_text->items + sizeof(msg) + branch_len;
+    result->output_len = msg.output_len;
+    result->output_truncated = msg.output_truncated;
+    result->error = NULL;
+    if (msg.error_len > 0) {
+        result->error = result->output + msg.output_len;
+        if (result->error[msg.error_len - 1])
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Prints out the output of the job with a single write, preceded by the
+ * description of the workspace if the job is the first of it.
+ */
+static void print_output(executor *obj, int job, const struct text *output)
+{
+    struct text *record = &obj->record;
+    text_clear(record);
+    int w = plan_get_workspace(obj->plan, job);
+    if (obj->options.headers && w != obj->last_workspace) {
+        char header[2 * MAX_PATH + 32];
+        int len = snprintf(header, sizeof(header), "Workspace %s (name: %s)\n",
+                plan_get_workspace_path(obj->plan, w),
+                plan_get_workspace_name(obj->plan, w));
+        text_append(record, header,
+                len < (int)sizeof(header) ? len : (int)sizeof(header) - 1);
+    }
+    obj->last_workspace = w;
+    text_append(record, output->items, output->size);
+    if (output->size && output->items[output->size - 1] != '\n')
+        text_append(record, "\n", 1);
+    if (obj->progress)
+        progress_write(obj->progress, record->items, record->size);
+    else
+        write_fully(STDOUT_FILENO, record->items, record->size);
+}
+
+/*
+ * Prints out the outputs of the jobs done in the order of the plan, as far
+ * as the jobs before them are done.
+ */
+static void print_outputs(executor *obj, bool all)
+{
+    int size = plan_get_size(obj->plan);
+    for (; obj->next_output < size; obj->next_output++) {
+        int job = obj->next_output;
+        if (!obj->done[job] && !all)
+            break;
+        if (obj->done[job]) {
+            print_output(obj, job, &obj->outputs[job]);
+            text_destroy(&obj->outputs[job]);
+        }
+    }
+}
+
+/*
+ * Collects the job done and passes its result to the handler. Returns false
+ * if the job was aborted.
+ */
+static bool finish_job(executor *obj, proc *proc, int i, void *inst,
+        void (*handle_result)(void *, int, const struct proc_result *))
+{
+    struct slot *slot = &obj->slots[i];
+    struct text msg_text;
+    text_init(&msg_text);
+    char branch[MAX_PATH];
+    struct proc_result result;
+    /* Closing the output first stops a job that is still writing */
+    close(slot->out_fd);
+    bool reported =
+            read_result(obj, proc, slot, &msg_text, branch, &result);
+    close(slot->result_fd);
+    int status = 0;
+    while (waitpid(slot->pid, &status, 0) < 0 && errno == EINTR)
+        ;
+    if (reported && handle_result)
+        handle_result(inst, slot->job, &result);
+    text_destroy(&msg_text);
+
+    if (obj->progress) {
+        progress_finish(obj->progress, slot->job, clock_ns());
+        print_output(obj, slot->job, &slot->output);
+        text_destroy(&slot->output);
+    } else {
+        obj->outputs[slot->job] = slot->output;
+        obj->done[slot->job] = true;
+        print_outputs(obj, false);
+    }
+    /* Fill the gap with the last slot */
+    obj->slots[i] = obj->slots[--obj->running];
+    return reported || (WIFEXITED(status) && !WEXITSTATUS(status));
+}
+
+bool executor_run(executor *obj, proc *proc, void *inst,
+        void (*handle_result)(void *, int, const struct proc_result *))
+{
+    int size = plan_get_size(obj->plan);
+    struct pollfd *fds =
+            malloc(obj->options.concurrency * sizeof(struct pollfd));
+    bool ok = true;
+    int next = 0;
+    while (true) {
+        while (ok && next < size && obj->running < obj->options.concurrency) {
+            if (!start_job(obj, proc, next)) {
+                ok = false;
+                break;
+            }
+            next++;
+        }
+        if (!obj->running)
+            break;
+
+        for (int i = 0; i < obj->running; i++) {
+            fds[i].fd = obj->slots[i].out_fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        int timeout = -1;
+        if (obj->progress)
+            timeout = progress_refresh(obj->progress, clock_ns());
+        if (poll(fds, obj->running, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            /* Fall back to blocking reads */
+            for (int i = 0; i < obj->running; i++)
+                fds[i].revents = POLLIN;
+        }
+        /* Go backwards since the slots of the jobs done get refilled */
+        for (int i = obj->running - 1; i >= 0; i--) {
+            if (fds[i].revents && !read_output(&obj->slots[i]))
+                ok = finish_job(obj, proc, i, inst, handle_result) && ok;
+        }
+    }
+    print_outputs(obj, true);
+    free(fds);
+    return ok;
+}
+
+void executor_destroy(executor *obj)
+{
+    if (obj->progress)
+        progress_destroy(obj->progress);
+    free(obj->slots);
+    free(obj->outputs);
+    free(obj->done);
+    text_destroy(&obj->record);
+    free(obj);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * executor.h
+ *
+ * Runs the jobs of a plan concurrently, each in a child process of its own.
+ * The output of a job is collected and printed out at once when the job is
+ * done: right away along with a live progress display on a terminal, or in
+ * the order of the plan otherwise.
+ */
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <stdbool.h>
+#include "plan.h"
+#include "proc.h"
+
+typedef struct executor_st executor;
+
+struct executor_options {
+    /* The maximum number of jobs run at once */
+    int concurrency;
+    /* Print out the description of each workspace before its projects */
+    bool headers;
+    /* Display the progress instead of keeping the order of the output */
+    bool progress;
+};
+
+executor *executor_new(plan *, const struct executor_options *);
+
+/*
+ * Sets the expected duration of the job in nanoseconds for the estimate of
+ * the time left.
+ */
+void executor_expect(executor *, int, long long);
+
+/*
+ * Takes the action of the processor on every job of the plan. The handler is
+ * passed the index of each job done and its result in this process. Returns
+ * false if a job was aborted by an error, in which case no more jobs are
+ * started.
+ */
+bool executor_run(executor *, proc *, void *,
+        void (*)(void *, int, const struct proc_result *));
+
+void executor_destroy(executor *);
+
+#endif /* EXECUTOR_H_ */
@@ -30,61 +30,100 @@
  */
 
 #include "hashmap.h"
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "containers.h"
+#include "utils.h"
+#include "alloctrace.h"
 
-/* Improvements I should consider:
- *   o Re-hashing
- *   o Better hashing algorithm
- */
+#define MIN_CAPACITY 8
 
 struct map_entry {
     struct map_entry *next;
+    unsigned hash;
     char *key;
     void *value;
 };
 
 CLASS(HHASHMAP)
 {
-    struct map_entry *buckets[HASHSIZE];
+    struct map_entry **buckets;
+    /* The number of buckets, always a power of two */
+    int capacity;
+    /* The size the buckets are doubled at */
+    int threshold;
     int size;
     float load_factor;
 };
 
-static unsigned hash(char *key)
-{
-    unsigned h;
-    for (h = 0; *key; key++)
-        h = *key + 31 * h;
-    return h % HASHSIZE;
-}
-
-/* Recursively removes map entries linked in a linked list */
-static void inline free_map_entry(struct map_entry *me)
+static inline void free_map_entry(struct map_entry *me)
 {
     free(me->key);
     free(me);
 }
 
-/* Recursively removes map entries linked in a linked list */
+/* Removes map entries linked in a linked list */
 static void free_map_entries(struct map_entry *me)
 {
-    if (me->next != NULL)
-        free_map_entries(me->next);
-    free_map_entry(me);
+    while (me) {
+        struct map_entry *next = me->next;
+        free_map_entry(me);
+        me = next;
+    }
 }
 
-static struct map_entry *lookup(HHASHMAP map, char *key)
+static inline struct map_entry **bucket(HHASHMAP map, unsigned h)
+{
+    return &map->buckets[h & (map->capacity - 1)];
+}
+
+static struct map_entry *lookup(HHASHMAP map, const char *key, unsigned h)
 {
     struct map_entry *me;
-    for (me = map->buckets[hash(key)]; me != NULL; me = me->next) {
-        if (strcmp(key, me->key) == 0)
+    for (me = *bucket(map, h); me != NULL; me = me->next) {
+        if (me->hash == h && strcmp(key, me->key) == 0)
             return me;
     }
     return NULL;
 }
 
+static bool alloc_buckets(HHASHMAP map, int capacity)
+{
+    map->buckets = calloc(capacity, sizeof(struct map_entry *));
+    if (!map->buckets)
+        return false;
+    map->capacity = capacity;
+    map->threshold = (int)(capacity * map->load_factor);
+    return true;
+}
+
+/* Doubles the number of buckets relinking the entries by their hashes */
+static void grow(HHASHMAP map)
+{
+    struct map_entry **old_buckets = map->buckets;
+    int old_capacity = map->capacity;
+    if (!alloc_buckets(map, old_capacity * 2)) {
+        /* Carry on with longer chains */
+        map->buckets = old_buckets;
+        map->threshold = INT_MAX;
+        return;
+    }
+    for (int i = 0; i < old_capacity; i++) {
+        struct map_entry *me = old_buckets[i];
+        while (me) {
+            struct map_entry *next = me->next;
+            struct map_entry **b = bucket(map, me->hash);
+            me->next = *b;
+            *b = me;
+            me = next;
+        }
+    }
+    free(old_buckets);
+}
+
 HHASHMAP hash_map_create()
 {
     return hash_map_create_ex(HASHSIZE, LOADFACTOR);
@@ -92,36 +131,46 @@ HHASHMAP hash_map_create()
 
 HHASHMAP hash_map_create_ex(int initSize, float loadFactor)
 {
-    (void)initSize; /* parameter not used, fixed bucket size */
     HHASHMAP map = malloc(sizeof(struct tagHHASHMAP));
     if (!map)
         return NULL;
-    for (int i = 0; i < HASHSIZE; i++)
-        map->buckets[i] = NULL;
+    map->load_factor = loadFactor > 0 ? loadFactor : LOADFACTOR;
+    int capacity = MIN_CAPACITY;
+    while (capacity < initSize && capacity < INT_MAX / 2)
+        capacity *= 2;
+    if (!alloc_buckets(map, capacity)) {
+        free(map);
+        return NULL;
+    }
     map->size = 0;
-    map->load_factor = loadFactor;
-    (void)initSize; /* parameter not used, fixed bucket size */
     return map;
 }
 
 void *hash_map_get(HHASHMAP map, char *key)
 {
-    struct map_entry *me = lookup(map, key);
+    struct map_entry *me = lookup(map, key, str_hash(key));
     return me != NULL ? me->value : NULL;
 }
 
 void *hash_map_put(HHASHMAP map, char *key, void *value)
 {
     struct map_entry *me;
-    unsigned h; /* Hash value */
+    unsigned h = str_hash(key);
     void *old_value = NULL;
-    if ((me = lookup(map, key)) == NULL) {
+    if ((me = lookup(map, key, h)) == NULL) {
         me = malloc(sizeof(*me));
-        if (me == NULL || (me->key = strdup(key)) == NULL)
+        if (me == NULL)
             return NULL;
-        h = hash(key);
-        me->next = map->buckets[h];
-        map->buckets[h] = me;
+        if ((me->key = strdup(key)) == NULL) {
+            free(me);
+            return NULL;
+        }
+        me->hash = h;
+        if (map->size >= map->threshold)
+            grow(map);
+        struct map_entry **b = bucket(map, h);
+        me->next = *b;
+        *b = me;
         map->size++;
     } else {
         old_value = me->value;
@@ -134,12 +183,12 @@ void *hash_map_put(HHASHMAP map, char *key, void *value)
 void *hash_map_remove(HHASHMAP map, char *key)
 {
     struct map_entry *me, *prev_me;
-    unsigned h = hash(key);
-    for (me = map->buckets[h], prev_me = NULL; me != NULL;
-            prev_me = me, me = me->next) {
-        if (strcmp(key, me->key) == 0) {
+    unsigned h = str_hash(key);
+    struct map_entry **b = bucket(map, h);
+    for (me = *b, prev_me = NULL; me != NULL; prev_me = me, me = me->next) {
+        if (me->hash == h && strcmp(key, me->key) == 0) {
             if (prev_me == NULL)
-                map->buckets[h] = me->next;
+                *b = me->next;
             else
                 prev_me->next = me->next;
             void *value = me->value;
@@ -158,7 +207,7 @@ char **hash_map_get_keys(HHASHMAP map)
     struct map_entry *me;
     if (!keys)
         return NULL;
-    for (int i = 0; i < HASHSIZE; i++) {
+    for (int i = 0; i < map->capacity; i++) {
         if (map->buckets[i] == NULL)
             continue;
         for (me = map->buckets[i]; me; me = me->next)
@@ -177,7 +226,7 @@ void hash_map_traverse(
         HHASHMAP map, void *inst, void (*visit)(void *, char *, void *))
 {
     struct map_entry *me;
-    for (int i = 0; i < HASHSIZE; i++) {
+    for (int i = 0; i < map->capacity; i++) {
         for (me = map->buckets[i]; me; me = me->next)
             visit(inst, me->key, me->value);
     }
@@ -186,7 +235,7 @@ void hash_map_traverse(
 void hash_map_clear(HHASHMAP map)
 {
     struct map_entry *me;
-    for (int i = 0; i < HASHSIZE; i++) {
+    for (int i = 0; i < map->capacity; i++) {
         me = map->buckets[i];
         if (me != NULL)
             free_map_entries(me);
@@ -198,5 +247,6 @@ void hash_map_clear(HHASHMAP map)
 void hash_map_destroy(HHASHMAP map)
 {
     hash_map_clear(map);
+    free(map->buckets);
     free(map);
 }
@@ -42,7 +42,11 @@ NEWHANDLE(HHASHMAP);
 /* Constructs a new instance of this hash map class */
 HHASHMAP hash_map_create(void);
 
-/* Constructs a new instance of this hash map class */
+/*
+ * Constructs a new instance of this hash map class with the specified initial
+ * number of buckets (rounded up to a power of two) and the load factor
+ * the number of buckets is doubled at
+ */
 HHASHMAP hash_map_create_ex(int, float);
 
 /* Returns a value from this map associated with a key */
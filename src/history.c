@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * history.c
+ *
+ * The history file starts with a magic number followed by the records, each
+ * of which is a fixed size header immediately followed by the workspace alias
+ * and the project name (not zero-terminated). The file is only ever appended
+ * to, so a record cut short by a crash can only be the last one.
+ */
+
+#include "history.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "alloctrace.h"
+
+#define MAGIC "OCTOHST1"
+#define MAGIC_LEN 8
+#define MAX_NAME_LEN 255
+
+/*
+ * The header of a record. The fields are ordered so that there is no
+ * padding between them.
+ */
+struct record_header {
+    int64_t timestamp;
+    int64_t duration_ns;
+    int64_t bytes;
+    int32_t exit_code;
+    uint8_t action;
+    uint8_t workspace_len;
+    uint8_t project_len;
+    uint8_t reserved;
+};
+
+struct history_st {
+    FILE *file;
+};
+
+history *history_new(const char *file_name)
+{
+    FILE *file = fopen(file_name, "ab");
+    if (!file)
+        return NULL;
+    /*
+     * Unbuffered so that each record is a single write which concurrent runs
+     * cannot interleave with
+     */
+    setvbuf(file, NULL, _IONBF, 0);
+    /* Stamp a new file with the magic number */
+    fseek(file, 0, SEEK_END);
+    if (!ftell(file))
+        fwrite(MAGIC, 1, MAGIC_LEN, file);
+    history *obj = malloc(sizeof(struct history_st));
+    obj->file = file;
+    return obj;
+}
+
+void history_add(
+        history *obj, const char *workspace, const struct proc_result *result)
+{
+    size_t workspace_len = strlen(workspace);
+    size_t project_len = strlen(result->project);
+    if (workspace_len > MAX_NAME_LEN || project_len > MAX_NAME_LEN)
+        return;
+
+    /* Assemble the record so that it is appended with a single write */
+    char record[sizeof(struct record_header) + 2 * MAX_NAME_LEN];
+    struct record_header header;
+    memset(&header, 0, sizeof(header));
+    header.timestamp = time(NULL);
+    header.duration_ns = result->duration_ns;
+    header.bytes = result->bytes;
+    header.exit_code = result->exit_code;
+    header.action = result->action;
+    header.workspace_len = workspace_len;
+    header.project_len = project_len;
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), workspace, workspace_len);
+    memcpy(record + sizeof(header) + workspace_len, result->project,
+            project_len);
+    fwrite(record, 1, sizeof(header) + workspace_len + project_len,
+            obj->file);
+}
+
+bool history_read(const char *file_name, void *inst,
+        void (*visit)(void *, const struct history_entry *))
+{
+    FILE *file = fopen(file_name, "rb");
+    if (!file)
+        return false;
+    char magic[MAGIC_LEN];
+    if (fread(magic, 1, MAGIC_LEN, file) != MAGIC_LEN ||
+            memcmp(magic, MAGIC, MAGIC_LEN)) {
+        fclose(file);
+        return false;
+    }
+
+    struct record_header header;
+    char workspace[MAX_NAME_LEN + 1];
+    char project[MAX_NAME_LEN + 1];
+    struct history_entry entry;
+    entry.workspace = workspace;
+    entry.project = project;
+    while (fread(&header, sizeof(header), 1, file) == 1) {
+        if (fread(workspace, 1, header.workspace_len, file) !=
+                        header.workspace_len ||
+                fread(project, 1, header.project_len, file) !=
+                        header.project_len)
+            break;
+        workspace[header.workspace_len] = 0;
+        project[header.project_len] = 0;
+        entry.action = header.action;
+        entry.exit_code = header.exit_code;
+        entry.timestamp = header.timestamp;
+        entry.duration_ns = header.duration_ns;
+        entry.bytes = header.bytes;
+        visit(inst, &entry);
+    }
+    fclose(file);
+    return true;
+}
+
+void history_destroy(history *obj)
+{
+    fclose(obj->file);
+    free(obj);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Append-only store of the results of the actions taken on the projects.
+ */
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <stdbool.h>
+#include "proc.h"
+
+typedef struct history_st history;
+
+/*
+ * A result read back from the history.
+ */
+struct history_entry {
+    enum action action;
+    const char *workspace;
+    const char *project;
+    int exit_code;
+    /* Seconds since the epoch when the result was recorded */
+    long long timestamp;
+    long long duration_ns;
+    long long bytes;
+};
+
+/*
+ * Opens the specified history file for appending. Returns NULL if the file
+ * cannot be opened.
+ */
+history *history_new(const char *);
+
+/*
+ * Appends the result of an action taken on a project of the named workspace.
+ */
+void history_add(history *, const char *, const struct proc_result *);
+
+/*
+ * Reads the specified history file passing each entry to the visitor in
+ * the order they were recorded. Returns false if the file cannot be read
+ * or is not a history file.
+ */
+bool history_read(
+        const char *, void *, void (*)(void *, const struct history_entry *));
+
+/*
+ * Flushes and closes the history.
+ */
+void history_destroy(history *);
+
+#endif /* HISTORY_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * journal.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "journal.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "containers.h"
+#include "ucache.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+/* The longest workspace or project name recorded */
+#define MAX_NAME_LEN 255
+/* The longest signature written to the header */
+#define MAX_SIGNATURE_LEN 1024
+
+DECLARE_STR_MAP(done_map, int)
+
+struct journal_st {
+    int fd;
+    char file_name[MAX_PATH];
+    /* The content of the previous journal the keys of the map point into */
+    char *content;
+    /* Exit codes by workspace and project, separated with a tab */
+    struct done_map done;
+};
+
+/*
+ * Formats the header line identifying the runs the journal is of, with
+ * the control characters of the signature turned into spaces.
+ */
+static void format_header(char *dst, const char *signature)
+{
+    int len = snprintf(dst, MAX_SIGNATURE_LEN + 3, "# %s", signature);
+    if (len > MAX_SIGNATURE_LEN + 1)
+        len = MAX_SIGNATURE_LEN + 1;
+    for (int i = 2; i < len; i++) {
+        if ((unsigned char)dst[i] < ' ')
+            dst[i] = ' ';
+    }
+    dst[len++] = '\n';
+    dst[len] = 0;
+}
+
+/* Reads the whole file into a null terminated buffer */
+static char *read_file(const char *file_name)
+{
+    FILE *file = fopen(file_name, "rb");
+    if (!file)
+        return NULL;
+    char *content = NULL;
+    long size;
+    if (!fseek(file, 0, SEEK_END) && (size = ftell(file)) >= 0 &&
+            !fseek(file, 0, SEEK_SET) && (content = malloc(size + 1))) {
+        size = fread(content, 1, size, file);
+        content[size] = 0;
+    }
+    fclose(file);
+    return content;
+}
+
+/*
+ * Reads back the results recorded by the previous run provided that it had
+ * the same signature.
+ */
+static void load(journal *obj, const char *header)
+{
+    obj->content = read_file(obj->file_name);
+    size_t header_len = strlen(header);
+    if (!obj->content || strncmp(obj->content, header, header_len))
+        return;
+    char *line = obj->content + header_len;
+    for (char *eol; (eol = strchr(line, '\n')); line = eol + 1) {
+        *eol = 0;
+        /* The key is the line up to the second tab */
+        char *tab = strchr(line, '\t');
+        char *code = tab ? strchr(tab + 1, '\t') : NULL;
+        if (!code)
+            continue;
+        *code++ = 0;
+        done_map_put(&obj->done, line, atoi(code));
+    }
+}
+
+/* Creates the directory along with the missing parent directories */
+static void make_dirs(const char *dir_name)
+{
+    char path[MAX_PATH];
+    snprintf(path, MAX_PATH, "%s", dir_name);
+    for (char *sep = path; (sep = strchr(sep + 1, path_separator()));) {
+        *sep = 0;
+        mkdir(path, 0755);
+        *sep = path_separator();
+    }
+    mkdir(path, 0755);
+}
+
+journal *journal_new(const char *dir_name, const char *signature, bool resume)
+{
+    journal *obj = malloc(sizeof(struct journal_st));
+    obj->content = NULL;
+    done_map_init(&obj->done);
+    /* The journals are named after the hash of the signature */
+    make_dirs(dir_name);
+    snprintf(obj->file_name, MAX_PATH, "%s%c%016llx", dir_name,
+            path_separator(),
+            (unsigned long long)ucache_hash(signature, strlen(signature)));
+    char header[MAX_SIGNATURE_LEN + 3];
+    format_header(header, signature);
+    if (resume)
+        load(obj, header);
+
+    /*
+     * Start over unless the previous journal is carried on with, and keep
+     * the records unbuffered so that each is a single write
+     */
+    int flags = O_WRONLY | O_CREAT | O_APPEND;
+    if (!obj->done.size)
+        flags |= O_TRUNC;
+    obj->fd = open(obj->file_name, flags, 0644);
+    if (obj->fd < 0) {
+        journal_destroy(obj);
+        return NULL;
+    }
+    if (!obj->done.size)
+        write_fully(obj->fd, header, strlen(header));
+    return obj;
+}
+
+const char *journal_get_file_name(journal *obj)
+{
+    return obj->file_name;
+}
+
+bool journal_is_done(journal *obj, const char *workspace, const char *project)
+{
+    char key[2 * MAX_NAME_LEN + 2];
+    if (!obj->done.size ||
+            snprintf(key, sizeof(key), "%s\t%s", workspace, project) >=
+                    (int)sizeof(key))
+        return false;
+    int *exit_code = done_map_get(&obj->done, key);
+    return exit_code && !*exit_code;
+}
+
+void journal_add(
+        journal *obj, const char *workspace, const struct proc_result *result)
+{
+    /* The names that cannot be told apart in the journal are left out, the
+     * project is just run again when resuming */
+    if (strlen(workspace) > MAX_NAME_LEN ||
+            strlen(result->project) > MAX_NAME_LEN ||
+            strpbrk(workspace, "\t\n") || strpbrk(result->project, "\t\n"))
+        return;
+    char record[2 * MAX_NAME_LEN + 32];
+    int exit_code = result->error && !result->exit_code ? -1
+                                                        : result->exit_code;
+    int len = snprintf(record, sizeof(record), "%s\t%s\t%d\n", workspace,
+            result->project, exit_code);
+    write_fully(obj->fd, record, len);
+}
+
+void journal_discard(journal *obj)
+{
+    remove(obj->file_name);
+}
+
+void journal_destroy(journal *obj)
+{
+    if (obj->fd >= 0)
+        close(obj->fd);
+    done_map_destroy(&obj->done);
+    free(obj->content);
+    free(obj);
+}
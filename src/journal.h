@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Journal of the projects a run has completed, which lets an interrupted
+ * run be resumed.
+ */
+
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include <stdbool.h>
+#include "proc.h"
+
+typedef struct journal_st journal;
+
+/*
+ * Opens the journal of the runs with the specified signature in the given
+ * directory. If resuming, the projects recorded by the previous run are
+ * read back, otherwise a new journal is started. Returns NULL if the journal
+ * cannot be written.
+ */
+journal *journal_new(const char *, const char *, bool);
+
+/*
+ * Returns the name of the journal file.
+ */
+const char *journal_get_file_name(journal *);
+
+/*
+ * Indicates if the previous run completed the action on the project of the
+ * named workspace successfully.
+ */
+bool journal_is_done(journal *, const char *, const char *);
+
+/*
+ * Records the result of an action taken on a project of the named workspace.
+ * Each record is a single write, so it survives the run being killed.
+ */
+void journal_add(journal *, const char *, const struct proc_result *);
+
+/*
+ * Removes the journal file once the run has succeeded on all the projects.
+ */
+void journal_discard(journal *);
+
+/*
+ * Closes the journal.
+ */
+void journal_destroy(journal *);
+
+#endif /* JOURNAL_H_ */
@@ -30,44 +30,46 @@
  */
 #include "linkedhashset.h"
 #include <stdlib.h>
-#include "hashmap.h"
-#include "linkedlist.h"
+#include "containers.h"
+#include "alloctrace.h"
+
+DECLARE_STR_SET(item_set)
 
 struct linked_hash_set_st {
-    HHASHMAP map;
-    HLINKEDLIST list;
+    struct item_set items;
 };
 
 linked_hash_set *linked_hash_set_new()
 {
     linked_hash_set *obj = malloc(sizeof(struct linked_hash_set_st));
-    obj->map = hash_map_create();
-    obj->list = linked_list_create();
+    item_set_init(&obj->items);
     return obj;
 }
 
-void linked_hash_set_add(linked_hash_set *obj, char *s)
+void linked_hash_set_add(linked_hash_set *obj, const char *s)
 {
-    if (hash_map_get(obj->map, s))
-        return;
-    hash_map_put(obj->map, s, s);
-    linked_list_add(obj->list, s);
+    item_set_add(&obj->items, s);
 }
 
 void linked_hash_set_traverse(linked_hash_set *obj, void *state,
         void (*handle)(void *state, void *value))
 {
-    linked_list_traverse(obj->list, state, handle);
+    STR_SET_FOREACH(item, &obj->items)
+        handle(state, (void *)*item);
+}
+
+const char *const *linked_hash_set_items(linked_hash_set *obj)
+{
+    return obj->items.keys.items;
 }
 
 int linked_hash_set_get_size(linked_hash_set *obj)
 {
-    return hash_map_get_size(obj->map);
+    return item_set_size(&obj->items);
 }
 
 void linked_hash_set_destroy(linked_hash_set *obj)
 {
-    linked_list_destroy(obj->list);
-    hash_map_destroy(obj->map);
+    item_set_destroy(&obj->items);
     free(obj);
 }
@@ -28,7 +28,9 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  *
- * A primitive implementation of linked hash set.
+ * A primitive implementation of linked hash set. The set borrows the items,
+ * which have to outlive it. Small sets are searched linearly and only larger
+ * ones are hashed.
  */
 
 #ifndef LINKEDHASHSET_H_
@@ -37,10 +39,25 @@
 typedef struct linked_hash_set_st linked_hash_set;
 
 linked_hash_set *linked_hash_set_new();
-void linked_hash_set_add(linked_hash_set *, char *);
+void linked_hash_set_add(linked_hash_set *, const char *);
 void linked_hash_set_traverse(
         linked_hash_set *, void *, void (*)(void *, void *));
 int linked_hash_set_get_size(linked_hash_set *);
+
+/*
+ * Returns the items in the order they were added. The array is valid until
+ * the next item is added.
+ */
+const char *const *linked_hash_set_items(linked_hash_set *);
+
+/*
+ * Iterates over the items of the set with var pointing to each in turn.
+ */
+#define LINKED_HASH_SET_FOREACH(var, set)                                      \
+    for (const char *const *var = linked_hash_set_items(set),                  \
+                           *const *var##_end =                                 \
+                                   var + linked_hash_set_get_size(set);        \
+            var < var##_end; var++)
 void linked_hash_set_destroy(linked_hash_set *);
 
 #endif /* LINKEDHASHSET_H_ */
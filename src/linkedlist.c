@@ -32,6 +32,7 @@
 #include "linkedlist.h"
 #include <stddef.h>
 #include <stdlib.h>
+#include "alloctrace.h"
 
 /* Linked list entry structure */
 struct entry {
@@ -40,9 +41,26 @@ struct entry {
     void *value;
 };
 
+/*
+ * The entries are carved out of blocks of doubling size and recycled through
+ * a free list, so that adding and removing does not go to the heap every
+ * time.
+ */
+struct entry_block {
+    struct entry_block *next_block;
+    int capacity;
+    int used;
+    struct entry entries[];
+};
+
+#define MIN_BLOCK_CAPACITY 8
+#define MAX_BLOCK_CAPACITY 1024
+
 struct tagHLINKEDLIST {
     struct entry *first_entry;
     int size;
+    struct entry_block *blocks;
+    struct entry *free_entries;
 };
 
 HLINKEDLIST linked_list_create()
@@ -50,15 +68,48 @@ HLINKEDLIST linked_list_create()
     HLINKEDLIST list = malloc(sizeof(struct tagHLINKEDLIST));
     list->first_entry = NULL;
     list->size = 0;
+    list->blocks = NULL;
+    list->free_entries = NULL;
     return list;
 }
 
+static struct entry *alloc_entry(HLINKEDLIST list)
+{
+    struct entry *e = list->free_entries;
+    if (e) {
+        list->free_entries = e->next_entry;
+        return e;
+    }
+    struct entry_block *b = list->blocks;
+    if (!b || b->used == b->capacity) {
+        int capacity = b ? 2 * b->capacity : MIN_BLOCK_CAPACITY;
+        if (capacity > MAX_BLOCK_CAPACITY)
+            capacity = MAX_BLOCK_CAPACITY;
+        b = malloc(sizeof(struct entry_block) +
+                capacity * sizeof(struct entry));
+        if (!b)
+            return NULL;
+        b->next_block = list->blocks;
+        b->capacity = capacity;
+        b->used = 0;
+        list->blocks = b;
+    }
+    return &b->entries[b->used++];
+}
+
+static void free_entry(HLINKEDLIST list, struct entry *e)
+{
+    e->next_entry = list->free_entries;
+    list->free_entries = e;
+}
+
 void linked_list_add(HLINKEDLIST list, void *value)
 {
     if (list == NULL)
         return;
     struct entry *last_entry, *second_last_entry;
-    last_entry = malloc(sizeof(struct entry));
+    if ((last_entry = alloc_entry(list)) == NULL)
+        return;
     if (list->first_entry == NULL) {
         list->first_entry = last_entry;
         last_entry->prev_entry = last_entry;
@@ -98,13 +149,12 @@ void *linked_list_remove_first(HLINKEDLIST list)
         return NULL;
     removed_value = fe->value;
     if (fe->next_entry == NULL) {
-        free(fe);
         list->first_entry = NULL;
     } else {
         list->first_entry = fe->next_entry;
-        free(fe);
-        list->first_entry->prev_entry = list->first_entry;
+        list->first_entry->prev_entry = fe->prev_entry;
     }
+    free_entry(list, fe);
     list->size--;
     return removed_value;
 }
@@ -118,13 +168,13 @@ void *linked_list_remove_last(HLINKEDLIST list)
         return NULL;
     if (fe->next_entry == NULL) {
         removed_value = fe->value;
-        free(fe);
+        free_entry(list, fe);
         list->first_entry = NULL;
     } else {
         removed_value = fe->prev_entry->value;
         /* this becomes last element */
         second_last_entry = fe->prev_entry->prev_entry;
-        free(fe->prev_entry);
+        free_entry(list, fe->prev_entry);
         fe->prev_entry = second_last_entry;
         second_last_entry->next_entry = NULL;
     }
@@ -162,7 +212,7 @@ void linked_list_clear(HLINKEDLIST list)
     for (e = list->first_entry; e;) {
         f = e;
         e = e->next_entry;
-        free(f);
+        free_entry(list, f);
     }
     list->first_entry = NULL;
     list->size = 0;
@@ -170,6 +220,10 @@ void linked_list_clear(HLINKEDLIST list)
 
 void linked_list_destroy(HLINKEDLIST list)
 {
-    linked_list_clear(list);
+    struct entry_block *b, *next;
+    for (b = list->blocks; b; b = next) {
+        next = b->next_block;
+        free(b);
+    }
     free(list);
 }
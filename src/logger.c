@@ -28,57 +28,293 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+
+#define _POSIX_C_SOURCE 200809L
+
 #include "logger.h"
+#include <pthread.h>
+#include <sched.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include "utils.h"
+#include "alloctrace.h"
+
+/* The size of the entry buffer of each thread (a power of two) */
+#define RING_LEN (64 * 1024)
+/* The longest entry written out, the longer ones are cut */
+#define LINE_LEN 2048
+/* How often the background thread writes out the queued up entries */
+#define DRAIN_INTERVAL_NS (20 * 1000 * 1000L)
+
+/*
+ * Buffer of the entries logged by a thread. Only the thread advances the
+ * head and only the writer advances the tail, so neither needs a lock.
+ */
+struct ring {
+    struct ring *next;
+    size_t head;
+    size_t tail;
+    /* The timestamp prefix is formatted once per second */
+    time_t stamp_time;
+    int stamp_len;
+    char stamp[64];
+    char data[RING_LEN];
+};
 
 struct logger_s {
     int session_id;
+    int level;
     FILE *file;
+    /* Whether the background thread is running */
+    bool async;
+    bool stop;
+    unsigned generation;
+    pthread_key_t key;
+    pthread_t writer;
+    /* Guards the draining of the buffers */
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+    struct ring *rings;
 };
 
-const char *log_levels[] = {"WARNING", "INFO", "DEBUG"};
+static const char *log_levels[] = {"WARNING", "INFO", "DEBUG"};
+
+static const char *level_names[] = {"warn", "info", "debug"};
+
+/* Incremented in the child on every fork */
+static unsigned fork_generation;
+static pthread_once_t atfork_once = PTHREAD_ONCE_INIT;
+
+static void count_fork(void)
+{
+    fork_generation++;
+}
+
+static void register_atfork(void)
+{
+    pthread_atfork(NULL, NULL, count_fork);
+}
+
+/*
+ * Writes out the entries queued up in the buffers. Expects the lock to be
+ * held.
+ */
+static void drain(logger *obj)
+{
+    bool flushed = false;
+    for (struct ring *ring = __atomic_load_n(&obj->rings, __ATOMIC_ACQUIRE);
+            ring; ring = ring->next) {
+        size_t tail = ring->tail;
+        size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (head == tail)
+            continue;
+        /* Keep the order of whatever is already buffered in the stream */
+        if (!flushed) {
+            fflush(obj->file);
+            flushed = true;
+        }
+        size_t at = tail & (RING_LEN - 1);
+        size_t len = head - tail;
+        size_t n = len < RING_LEN - at ? len : RING_LEN - at;
+        write_fully(fileno(obj->file), ring->data + at, n);
+        write_fully(fileno(obj->file), ring->data, len - n);
+        __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+    }
+}
+
+static void *run_writer(void *arg)
+{
+    logger *obj = arg;
+    pthread_mutex_lock(&obj->lock);
+    while (!obj->stop) {
+        drain(obj);
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += DRAIN_INTERVAL_NS;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&obj->wakeup, &obj->lock, &ts);
+    }
+    drain(obj);
+    pthread_mutex_unlock(&obj->lock);
+    return NULL;
+}
 
 logger *logger_create(int session_id, FILE *file)
 {
+    if (session_id < -1)
+        return NULL;
     logger *obj = (logger *)malloc(sizeof(logger));
     if (obj == NULL)
         return NULL;
-    if (session_id < -1)
-        return NULL;
     obj->session_id = session_id;
-    obj->file = file;
+    obj->level = LOGLEVEL_DEFAULT;
+    obj->file = file ? file : stdout;
+    obj->stop = false;
+    obj->rings = NULL;
+    pthread_once(&atfork_once, register_atfork);
+    obj->generation = fork_generation;
+    pthread_key_create(&obj->key, NULL);
+    pthread_mutex_init(&obj->lock, NULL);
+    pthread_cond_init(&obj->wakeup, NULL);
+    /* Fall back to writing the entries out straight away */
+    obj->async = !pthread_create(&obj->writer, NULL, run_writer, obj);
     return obj;
 }
 
+void logger_set_level(logger *obj, int level)
+{
+    __atomic_store_n(&obj->level, level, __ATOMIC_RELAXED);
+}
+
+int logger_get_level(logger *obj)
+{
+    return __atomic_load_n(&obj->level, __ATOMIC_RELAXED);
+}
+
+int logger_parse_level(const char *name)
+{
+    for (int i = 0; i <= LOGLEVEL_MAX; i++) {
+        if (!strcmp(name, level_names[i]))
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Returns the buffer of the calling thread, which is allocated on the
+ * first entry the thread logs.
+ */
+static struct ring *get_ring(logger *obj)
+{
+    struct ring *ring = pthread_getspecific(obj->key);
+    if (ring)
+        return ring;
+    ring = malloc(sizeof(struct ring));
+    if (!ring)
+        return NULL;
+    ring->head = ring->tail = 0;
+    ring->stamp_time = (time_t)-1;
+    /*
+     * Prepend the buffer without taking the lock, which a forked child may
+     * have inherited held by the writer of the parent
+     */
+    ring->next = __atomic_load_n(&obj->rings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&obj->rings, &ring->next, ring, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+    pthread_setspecific(obj->key, ring);
+    return ring;
+}
+
+static void format_stamp(logger *obj, struct ring *ring, time_t now)
+{
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    int n = snprintf(ring->stamp, sizeof(ring->stamp),
+            "%02d/%02d/%d %02d:%02d:%02d ", tm.tm_mday, tm.tm_mon + 1,
+            tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    /* No session allocated to this logger otherwise */
+    if (obj->session_id > -1)
+        n += snprintf(ring->stamp + n, sizeof(ring->stamp) - n, "S%d",
+                obj->session_id);
+    ring->stamp_len = n;
+    ring->stamp_time = now;
+}
+
+static size_t format_line(logger *obj, struct ring *ring, int level,
+        char *line, const char *fmt, va_list args)
+{
+    time_t now = time(NULL);
+    if (now != ring->stamp_time)
+        format_stamp(obj, ring, now);
+    size_t len = ring->stamp_len;
+    memcpy(line, ring->stamp, len);
+    len += snprintf(line + len, LINE_LEN - len, "[%s] ", log_levels[level]);
+    int n = vsnprintf(line + len, LINE_LEN - len, fmt, args);
+    if (n > 0)
+        len += (size_t)n < LINE_LEN - len ? (size_t)n : LINE_LEN - len - 1;
+    return len;
+}
+
+/*
+ * Queues up the entry in the buffer of the thread, waiting for the writer
+ * to make room if it is full.
+ */
+static void push(logger *obj, struct ring *ring, const char *line, size_t len)
+{
+    size_t head = ring->head;
+    while (RING_LEN - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) <
+            len) {
+        pthread_mutex_lock(&obj->lock);
+        pthread_cond_signal(&obj->wakeup);
+        pthread_mutex_unlock(&obj->lock);
+        sched_yield();
+    }
+    size_t at = head & (RING_LEN - 1);
+    size_t n = len < RING_LEN - at ? len : RING_LEN - at;
+    memcpy(ring->data + at, line, n);
+    memcpy(ring->data, line + n, len - n);
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+}
+
 void logger_log(logger *obj, int level, char *fmt, ...)
 {
-    if (level > LOGLEVEL_MAX)
+    if (level > LOGLEVEL_MAX || level > logger_get_level(obj))
+        return;
+    struct ring *ring = get_ring(obj);
+    if (!ring)
         return;
 
-    time_t ctime = time(NULL);
-    struct tm *tm = gmtime(&ctime);
-
-    FILE *file = obj->file ? obj->file : stdout;
-    if (obj->session_id > -1) {
-        fprintf(file, "%02d/%02d/%d %02d:%02d:%02d S%d[%s] ", tm->tm_mday,
-                tm->tm_mon + 1, tm->tm_year + 1900, tm->tm_hour, tm->tm_min,
-                tm->tm_sec, obj->session_id, log_levels[level]);
-    } else {
-        /* No session allocated to this logger */
-        fprintf(file, "%02d/%02d/%d %02d:%02d:%02d [%s] ", tm->tm_mday,
-                tm->tm_mon + 1, tm->tm_year + 1900, tm->tm_hour, tm->tm_min,
-                tm->tm_sec, log_levels[level]);
-    }
+    char line[LINE_LEN];
     va_list args;
     va_start(args, fmt);
-    vfprintf(file, fmt, args);
+    size_t len = format_line(obj, ring, level, line, fmt, args);
     va_end(args);
+    /* There is no background thread in a forked child */
+    if (obj->async && obj->generation == fork_generation)
+        push(obj, ring, line, len);
+    else
+        fwrite(line, 1, len, obj->file);
+}
+
+void logger_flush(logger *obj)
+{
+    if (!obj->async || obj->generation != fork_generation) {
+        fflush(obj->file);
+        return;
+    }
+    pthread_mutex_lock(&obj->lock);
+    drain(obj);
+    pthread_mutex_unlock(&obj->lock);
 }
 
 void logger_destroy(logger *obj)
 {
+    /* The lock of a forked child may be held by the writer of the parent */
+    bool forked = obj->generation != fork_generation;
+    if (obj->async && !forked) {
+        pthread_mutex_lock(&obj->lock);
+        obj->stop = true;
+        pthread_cond_signal(&obj->wakeup);
+        pthread_mutex_unlock(&obj->lock);
+        pthread_join(obj->writer, NULL);
+    }
+    while (obj->rings) {
+        struct ring *ring = obj->rings;
+        obj->rings = ring->next;
+        free(ring);
+    }
+    if (!forked) {
+        pthread_cond_destroy(&obj->wakeup);
+        pthread_mutex_destroy(&obj->lock);
+    }
+    pthread_key_delete(obj->key);
     free(obj);
 }
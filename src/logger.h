@@ -41,16 +41,18 @@
 #define LOGLEVEL_DEBUG 2
 #define LOGLEVEL_MAX LOGLEVEL_DEBUG
 
+#ifdef DEBUG
+#define LOGLEVEL_DEFAULT LOGLEVEL_DEBUG
+#else
+#define LOGLEVEL_DEFAULT LOGLEVEL_INFO
+#endif
+
 /**
- * The debug entries using this macro will not be included in
- * the releases.
+ * The debug entries are only written out if the level of the logger is
+ * raised to LOGLEVEL_DEBUG, which is the default in the debug builds.
  */
-#ifdef DEBUG
 #define DEBUG_LOG(obj, fmt, ...) \
     logger_log(obj, LOGLEVEL_DEBUG, fmt, ##__VA_ARGS__)
-#else
-#define DEBUG_LOG(obj, fmt, ...)
-#endif
 
 #define logger_warn(obj, fmt, ...) \
     logger_log(obj, LOGLEVEL_WARN, fmt, ##__VA_ARGS__)
@@ -59,11 +61,23 @@
 #define logger_debug(obj, fmt, ...) \
     logger_log(obj, LOGLEVEL_DEBUG, fmt, ##__VA_ARGS__)
 
-/** The main logger class */
+/**
+ * The main logger class. The entries are queued up in a buffer of the
+ * calling thread and written out to the file by a background thread, so
+ * the logger may be used from several threads at once. In a forked child
+ * the entries are written out straight away.
+ */
 typedef struct logger_s logger;
 
 logger *logger_create(int, FILE *);
+/** Only the entries up to the specified level are written out */
+void logger_set_level(logger *, int);
+int logger_get_level(logger *);
+/** Returns the level named warn, info or debug, or -1 */
+int logger_parse_level(const char *);
 void logger_log(logger *, int, char *fmt, ...);
+/** Writes out the entries queued up so far */
+void logger_flush(logger *);
 void logger_destroy(logger *);
 
 #endif
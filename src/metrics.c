@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * metrics.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "containers.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+struct record {
+    const char *workspace;
+    struct proc_result result;
+};
+
+/*
+ * Per workspace totals.
+ */
+struct totals {
+    const char *workspace;
+    enum action action;
+    int projects;
+    int failures;
+    int dirty;
+    long long duration_ns;
+};
+
+/*
+ * Metric families exposed per project.
+ */
+enum project_metric {
+    DURATION,
+    EXIT_CODE,
+    DIRTY,
+    AHEAD,
+    BEHIND,
+    PROJECT_METRICS
+};
+
+static const char *PROJECT_METRIC_NAMES[][2] = {
+        {"octo_project_duration_seconds",
+                "Time taken by the action on the project."},
+        {"octo_project_exit_code", "Exit code of the action on the project."},
+        {"octo_project_dirty",
+                "Whether the working tree of the project has changes."},
+        {"octo_project_ahead_commits",
+                "Commits the project branch is ahead of its upstream."},
+        {"octo_project_behind_commits",
+                "Commits the project branch is behind its upstream."}};
+
+DECLARE_VECTOR(record_vector, struct record)
+DECLARE_VECTOR(totals_vector, struct totals)
+
+struct metrics_st {
+    struct record_vector records;
+};
+
+metrics *metrics_new()
+{
+    metrics *obj = malloc(sizeof(struct metrics_st));
+    record_vector_init(&obj->records);
+    return obj;
+}
+
+void metrics_add(
+        metrics *obj, const char *workspace, const struct proc_result *result)
+{
+    struct record record;
+    record.workspace = workspace;
+    record.result = *result;
+    record_vector_push(&obj->records, record);
+}
+
+/* Writes the label value escaped as the exposition format requires */
+static void write_label_value(FILE *file, const char *s)
+{
+    for (; *s; s++) {
+        if (*s == '\\' || *s == '"')
+            fputc('\\', file);
+        if (*s == '\n')
+            fputs("\\n", file);
+        else
+            fputc(*s, file);
+    }
+}
+
+static void write_labels(FILE *file, const char *workspace,
+        const char *project, enum action action)
+{
+    fputs("{workspace=\"", file);
+    write_label_value(file, workspace);
+    if (project) {
+        fputs("\",project=\"", file);
+        write_label_value(file, project);
+    }
+    fprintf(file, "\",action=\"%s\"}", proc_action_name(action));
+}
+
+static void write_family(FILE *file, const char *name, const char *help)
+{
+    fprintf(file, "# TYPE %s gauge\n# HELP %s %s\n", name, name, help);
+}
+
+/*
+ * Writes the project sample of the specified metric unless its value is
+ * unknown.
+ */
+static void write_project_sample(
+        FILE *file, enum project_metric metric, const struct record *record)
+{
+    const struct proc_result *r = &record->result;
+    int n;
+    switch (metric) {
+    case DURATION:
+        fputs(PROJECT_METRIC_NAMES[DURATION][0], file);
+        write_labels(file, record->workspace, r->project, r->action);
+        fprintf(file, " %.6f\n", r->duration_ns / 1e9);
+        return;
+    case EXIT_CODE:
+        n = r->exit_code;
+        break;
+    case DIRTY:
+        n = r->dirty;
+        break;
+    case AHEAD:
+        n = r->ahead;
+        break;
+    default:
+        n = r->behind;
+        break;
+    }
+    if (metric != EXIT_CODE && n < 0)
+        return;
+    fputs(PROJECT_METRIC_NAMES[metric][0], file);
+    write_labels(file, record->workspace, r->project, r->action);
+    fprintf(file, " %d\n", n);
+}
+
+/*
+ * Sums up the records per workspace and action. The records of a workspace
+ * are adjacent so only the last totals need to be checked.
+ */
+static void add_up_totals(metrics *obj, struct totals_vector *totals)
+{
+    struct totals *t = NULL;
+    VECTOR_FOREACH(struct record, record, &obj->records) {
+        if (!t || strcmp(t->workspace, record->workspace) ||
+                t->action != record->result.action) {
+            struct totals empty;
+            memset(&empty, 0, sizeof(empty));
+            empty.workspace = record->workspace;
+            empty.action = record->result.action;
+            if (!totals_vector_push(totals, empty))
+                return;
+            t = &totals->items[totals->size - 1];
+        }
+        t->projects++;
+        t->failures += record->result.exit_code != 0;
+        t->dirty += record->result.dirty > 0;
+        t->duration_ns += record->result.duration_ns;
+    }
+}
+
+static void write_metrics(metrics *obj, FILE *file)
+{
+    for (int m = 0; m < PROJECT_METRICS; m++) {
+        write_family(file, PROJECT_METRIC_NAMES[m][0],
+                PROJECT_METRIC_NAMES[m][1]);
+        VECTOR_FOREACH(struct record, record, &obj->records)
+            write_project_sample(file, m, record);
+    }
+
+    /* Aggregate the results per workspace */
+    struct totals_vector totals;
+    totals_vector_init(&totals);
+    add_up_totals(obj, &totals);
+    write_family(file, "octo_workspace_projects",
+            "Projects the action was taken on in the workspace.");
+    VECTOR_FOREACH(struct totals, t, &totals) {
+        fputs("octo_workspace_projects", file);
+        write_labels(file, t->workspace, NULL, t->action);
+        fprintf(file, " %d\n", t->projects);
+    }
+    write_family(file, "octo_workspace_failures",
+            "Projects in the workspace the action failed on.");
+    VECTOR_FOREACH(struct totals, t, &totals) {
+        fputs("octo_workspace_failures", file);
+        write_labels(file, t->workspace, NULL, t->action);
+        fprintf(file, " %d\n", t->failures);
+    }
+    write_family(file, "octo_workspace_dirty_projects",
+            "Projects in the workspace with changes in the working tree.");
+    VECTOR_FOREACH(struct totals, t, &totals) {
+        fputs("octo_workspace_dirty_projects", file);
+        write_labels(file, t->workspace, NULL, t->action);
+        fprintf(file, " %d\n", t->dirty);
+    }
+    write_family(file, "octo_workspace_duration_seconds",
+            "Total time taken by the action in the workspace.");
+    VECTOR_FOREACH(struct totals, t, &totals) {
+        fputs("octo_workspace_duration_seconds", file);
+        write_labels(file, t->workspace, NULL, t->action);
+        fprintf(file, " %.6f\n", t->duration_ns / 1e9);
+    }
+    totals_vector_destroy(&totals);
+
+    write_family(file, "octo_last_run_timestamp_seconds",
+            "Time the results were written at.");
+    fprintf(file, "octo_last_run_timestamp_seconds %ld\n", (long)time(NULL));
+    fputs("# EOF\n", file);
+}
+
+bool metrics_write(metrics *obj, const char *file_name)
+{
+    /*
+     * Write a temporary file next to the target and rename it so that
+     * the collector never sees a partially written file.
+     */
+    char tmp_name[MAX_PATH];
+    snprintf(tmp_name, MAX_PATH, "%s.%ld.tmp", file_name, (long)getpid());
+    FILE *file = fopen(tmp_name, "w");
+    if (!file)
+        return false;
+    write_metrics(obj, file);
+    bool ok = !ferror(file) && !fflush(file) && !fsync(fileno(file));
+    ok = !fclose(file) && ok;
+    if (!ok || rename(tmp_name, file_name)) {
+        remove(tmp_name);
+        return false;
+    }
+    return true;
+}
+
+void metrics_destroy(metrics *obj)
+{
+    record_vector_destroy(&obj->records);
+    free(obj);
+}
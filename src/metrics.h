@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * OpenMetrics text exposition of the results of a run, suitable for the
+ * textfile collector of the Prometheus node exporter.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stdbool.h>
+#include "proc.h"
+
+typedef struct metrics_st metrics;
+
+/*
+ * Creates a new metrics collector.
+ */
+metrics *metrics_new();
+
+/*
+ * Records the result of an action taken on a project of the named workspace.
+ * The strings referenced by the result must outlive this collector.
+ */
+void metrics_add(metrics *, const char *, const struct proc_result *);
+
+/*
+ * Atomically replaces the specified file with the collected metrics. Returns
+ * false if the file could not be written.
+ */
+bool metrics_write(metrics *, const char *);
+
+/*
+ * Destroys the specified metrics collector.
+ */
+void metrics_destroy(metrics *);
+
+#endif /* METRICS_H_ */
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ndjson.c
+ */
+
+#include "ndjson.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+DECLARE_VECTOR(text, char)
+
+struct ndjson_st {
+    int fd;
+    /* The record being built, reused from one record to the next */
+    struct text record;
+    bool out_of_memory;
+};
+
+ndjson *ndjson_new(int fd)
+{
+    ndjson *obj = malloc(sizeof(struct ndjson_st));
+    obj->fd = fd;
+    text_init(&obj->record);
+    obj->out_of_memory = false;
+    return obj;
+}
+
+static void append(ndjson *obj, const char *s, int len)
+{
+    if (!text_append(&obj->record, s, len))
+        obj->out_of_memory = true;
+}
+
+static void append_str(ndjson *obj, const char *s)
+{
+    append(obj, s, strlen(s));
+}
+
+/*
+ * Appends the characters as a JSON string. The bytes of non-ASCII characters
+ * are copied as they are.
+ */
+static void append_string(ndjson *obj, const char *s, int len)
+{
+    append(obj, "\"", 1);
+    const char *end = s + len;
+    while (s < end) {
+        /* Copy the run of characters that need no escaping at once */
+        const char *run = s;
+        while (s < end && (unsigned char)*s >= 0x20 && *s != '"' && *s != '\\')
+            s++;
+        append(obj, run, s - run);
+        if (s == end)
+            break;
+        char escape[8];
+        switch (*s) {
+        case '"':
+            append(obj, "\\\"", 2);
+            break;
+        case '\\':
+            append(obj, "\\\\", 2);
+            break;
+        case '\n':
+            append(obj, "\\n", 2);
+            break;
+        case '\r':
+            append(obj, "\\r", 2);
+            break;
+        case '\t':
+            append(obj, "\\t", 2);
+            break;
+        default:
+            snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*s);
+            append(obj, escape, 6);
+            break;
+        }
+        s++;
+    }
+    append(obj, "\"", 1);
+}
+
+static void append_field(ndjson *obj, const char *name, bool first)
+{
+    if (!first)
+        append(obj, ",", 1);
+    append(obj, "\"", 1);
+    append_str(obj, name);
+    append(obj, "\":", 2);
+}
+
+static void append_string_field(
+        ndjson *obj, const char *name, const char *value, bool first)
+{
+    append_field(obj, name, first);
+    if (value)
+        append_string(obj, value, strlen(value));
+    else
+        append(obj, "null", 4);
+}
+
+/*
+ * Appends the number field, or null if the number is negative (unknown).
+ */
+static void append_int_field(ndjson *obj, const char *name, int value)
+{
+    append_field(obj, name, false);
+    char number[16];
+    if (value < 0)
+        append(obj, "null", 4);
+    else
+        append(obj, number, snprintf(number, sizeof(number), "%d", value));
+}
+
+/*
+ * Terminates the record and writes it at once.
+ */
+static bool flush_record(ndjson *obj)
+{
+    append(obj, "}\n", 2);
+    struct text *t = &obj->record;
+    bool ok = !obj->out_of_memory && write_fully(obj->fd, t->items, t->size);
+    text_clear(&obj->record);
+    obj->out_of_memory = false;
+    return ok;
+}
+
+/*
+ * Returns the length of the output without a trailing partial UTF-8
+ * sequence, which the truncation may have cut.
+ */
+static int trim_partial_char(const char *s, int len)
+{
+    int i = len;
+    while (i > 0 && i > len - 4 && ((unsigned char)s[i - 1] & 0xc0) == 0x80)
+        i--;
+    if (i > 0 && ((unsigned char)s[i - 1] & 0xc0) == 0xc0) {
+        unsigned char lead = s[i - 1];
+        int char_len = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : 2;
+        if (len - (i - 1) < char_len)
+            return i - 1;
+    }
+    return len;
+}
+
+bool ndjson_write_result(
+        ndjson *obj, const char *workspace, const struct proc_result *result)
+{
+    append(obj, "{", 1);
+    append_string_field(obj, "workspace", workspace, true);
+    append_string_field(obj, "project", result->project, false);
+    append_string_field(obj, "path", result->project_path, false);
+    append_string_field(
+            obj, "action", proc_action_name(result->action), false);
+    append_field(obj, "exit_code", false);
+    char number[32];
+    append(obj, number,
+            snprintf(number, sizeof(number), "%d", result->exit_code));
+    append_string_field(obj, "branch", result->branch, false);
+    append_field(obj, "dirty", false);
+    append_str(obj, result->dirty < 0 ? "null"
+                    : result->dirty  ? "true"
+                                     : "false");
+    append_int_field(obj, "ahead", result->ahead);
+    append_int_field(obj, "behind", result->behind);
+    append_field(obj, "duration", false);
+    append(obj, number,
+            snprintf(number, sizeof(number), "%.6f",
+                    result->duration_ns / 1e9));
+    append_field(obj, "output", false);
+    int len = result->output_len;
+    if (result->output_truncated)
+        len = trim_partial_char(result->output, len);
+    append_string(obj, result->output ? result->output : "", len);
+    append_field(obj, "output_truncated", false);
+    append_str(obj, result->output_truncated ? "true" : "false");
+    append_string_field(obj, "error", result->error, false);
+    return flush_record(obj);
+}
+
+bool ndjson_write_job(ndjson *obj, int index, const char *workspace,
+        const char *project, const char *project_path)
+{
+    append(obj, "{", 1);
+    append_field(obj, "index", true);
+    char number[16];
+    append(obj, number, snprintf(number, sizeof(number), "%d", index));
+    append_string_field(obj, "workspace", workspace, false);
+    append_string_field(obj, "project", project, false);
+    append_string_field(obj, "path", project_path, false);
+    return flush_record(obj);
+}
+
+bool ndjson_write_path(ndjson *obj, const char *project_path)
+{
+    append(obj, "{", 1);
+    append_string_field(obj, "path", project_path, true);
+    return flush_record(obj);
+}
+
+void ndjson_destroy(ndjson *obj)
+{
+    text_destroy(&obj->record);
+    free(obj);
+}
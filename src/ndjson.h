@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ndjson.h
+ *
+ * Newline delimited JSON output. Every record is a single JSON object on its
+ * own line, written with a single write so that the records of concurrent
+ * writers do not interleave and readers can process them as they come.
+ */
+
+#ifndef NDJSON_H_
+#define NDJSON_H_
+
+#include "proc.h"
+
+typedef struct ndjson_st ndjson;
+
+/*
+ * Constructs a writer of the records to the specified file descriptor.
+ */
+ndjson *ndjson_new(int);
+
+/*
+ * Writes the result of the action taken on a project of the named
+ * workspace. Returns false if the record could not be written.
+ */
+bool ndjson_write_result(ndjson *, const char *, const struct proc_result *);
+
+/*
+ * Writes the job with the specified index, workspace name, project name and
+ * project path.
+ */
+bool ndjson_write_job(ndjson *, int, const char *, const char *, const char *);
+
+/*
+ * Writes the specified path to a project.
+ */
+bool ndjson_write_path(ndjson *, const char *);
+
+void ndjson_destroy(ndjson *);
+
+#endif /* NDJSON_H_ */
@@ -32,58 +32,239 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "cmdline.h"
 #include "config.h"
+#include "executor.h"
+#include "history.h"
+#include "journal.h"
+#include "metrics.h"
+#include "ndjson.h"
+#include "plan.h"
 #include "proc.h"
+#include "stats.h"
+#include "summary.h"
 #include "universe.h"
 #include "utils.h"
+#include "where.h"
+#include "xsystem.h"
 
 #define APP_VERSION "0.1.3b"
 
+/* The exit status if the action failed on some of the projects */
+#define EXIT_PARTIAL_FAILURE 2
+/* The longest signature of a run told apart by the journal */
+#define SIGNATURE_LEN 8192
+
 struct app_context {
     config *config;
     logger *logger;
     proc *proc;
     universe *universe;
-    char *last_name;
+    metrics *metrics;
+    history *history;
+    summary *summary;
+    journal *journal;
+    where *where;
+    ndjson *ndjson;
+    plan *plan;
+    const char *last_name;
 };
 
 /*
- * Visits the specified file.
+ * Handles the result of an action taken on a project.
  */
-static void visit(
-        void *inst, const char *name, const char *path, const char *project)
+static void handle_result(void *inst, const struct proc_result *result)
 {
     struct app_context *context = inst;
-    DEBUG_LOG(context->logger, "Visiting workspace: %s, %s: %s\n", name, path,
-            project);
-
-    /* Return if the workspace name is set but not matched */
-    char *wname = config_get_workspace_name(context->config);
-    if (wname && strcmp(wname, name))
+    if (context->ndjson)
+        ndjson_write_result(context->ndjson, context->last_name, result);
+    /* Listing does not act on the repositories */
+    if (result->action == LIST)
         return;
+    if (context->metrics)
+        metrics_add(context->metrics, context->last_name, result);
+    if (context->history)
+        history_add(context->history, context->last_name, result);
+    if (context->summary)
+        summary_add(context->summary, context->last_name, result);
+    if (context->journal)
+        journal_add(context->journal, context->last_name, result);
+}
+
+/*
+ * Takes the action on every project of the plan in turn.
+ */
+static void run_plan(struct app_context *context, plan *plan)
+{
+    int last_workspace = -1;
+    for (int i = 0; i < plan_get_size(plan); i++) {
+        int w = plan_get_workspace(plan, i);
+        const char *path = plan_get_workspace_path(plan, w);
+        /* Print out the description of each workspace before its projects */
+        if (w != last_workspace) {
+            last_workspace = w;
+            context->last_name = plan_get_workspace_name(plan, w);
+            if (!proc_is_silent(context->proc))
+                printf("Workspace %s (name: %s)\n", path, context->last_name);
+        }
+        DEBUG_LOG(context->logger, "Running job %d: %s\n", i,
+                plan_get_project_path(plan, i));
+        proc_action(context->proc, path, plan_get_project(plan, i),
+                plan_get_project_path(plan, i));
+    }
+}
+
+/*
+ * Handles the result of a job run by the executor.
+ */
+static void handle_job_result(
+        void *inst, int job, const struct proc_result *result)
+{
+    struct app_context *context = inst;
+    plan *plan = context->plan;
+    context->last_name =
+            plan_get_workspace_name(plan, plan_get_workspace(plan, job));
+    handle_result(context, result);
+}
+
+/*
+ * Takes the expected duration of each job for the progress estimates from
+ * the median of its past runs.
+ */
+static void expect_durations(
+        struct app_context *context, plan *plan, executor *executor)
+{
+    enum action action = proc_get_action(context->proc);
+    stats *stats = stats_new(context->universe,
+            config_get_workspace_name(context->config), action);
+    if (stats_load(stats, config_get_history_file_name(context->config))) {
+        struct stats_summary summary;
+        for (int i = 0; i < plan_get_size(plan); i++) {
+            if (stats_get(stats,
+                        plan_get_workspace_name(
+                                plan, plan_get_workspace(plan, i)),
+                        plan_get_project(plan, i), action, &summary))
+                executor_expect(executor, i, summary.p50_ns);
+        }
+    }
+    stats_destroy(stats);
+}
+
+/*
+ * Takes the action on the projects of the plan concurrently. Returns false
+ * if a job was aborted.
+ */
+static bool run_plan_concurrently(struct app_context *context, plan *plan)
+{
+    struct executor_options options;
+    options.concurrency = config_get_jobs(context->config);
+    options.headers = !proc_is_silent(context->proc);
+    /* The progress would get in the way of the records */
+    options.progress = !context->ndjson && isatty(STDOUT_FILENO);
+    executor *executor = executor_new(plan, &options);
+    if (options.progress)
+        expect_durations(context, plan, executor);
+    context->plan = plan;
+    bool ok = executor_run(
+            executor, context->proc, context, handle_job_result);
+    context->plan = NULL;
+    executor_destroy(executor);
+    return ok;
+}
+
+/*
+ * Returns true if the job satisfies the where expression.
+ */
+static bool select_job(void *inst, plan *plan, int job)
+{
+    struct app_context *context = inst;
+    bool selected = where_match(context->where,
+            plan_get_workspace_name(plan, plan_get_workspace(plan, job)),
+            plan_get_project(plan, job), plan_get_project_path(plan, job));
+    DEBUG_LOG(context->logger, "Job %d %s\n", job,
+            selected ? "selected" : "skipped");
+    return selected;
+}
+
+/*
+ * Opens the journal of the runs of the same command with the same arguments
+ * on the same selection of projects.
+ */
+static journal *open_journal(
+        struct app_context *context, int argc, char *argv[])
+{
+    char signature[SIGNATURE_LEN];
+    config *config = context->config;
+    const char *workspace = config_get_workspace_name(config);
+    const char *where = config_get_where(config);
+    int len = snprintf(signature, SIGNATURE_LEN, "%s\t%s\t%s",
+            config_get_def_file_name(config), workspace ? workspace : "",
+            where ? where : "");
+    for (int i = config_get_opt_limit(config); i < argc && len < SIGNATURE_LEN;
+            i++)
+        len += snprintf(signature + len, SIGNATURE_LEN - len, "\t%s", argv[i]);
+    return journal_new(config_get_journal_dir_name(config), signature,
+            config_is_resume(config));
+}
+
+/*
+ * Returns true unless the interrupted run being resumed has already taken
+ * the action on the project.
+ */
+static bool select_undone_job(void *inst, plan *plan, int job)
+{
+    struct app_context *context = inst;
+    return !journal_is_done(context->journal,
+            plan_get_workspace_name(plan, plan_get_workspace(plan, job)),
+            plan_get_project(plan, job));
+}
+
+/*
+ * Drops the jobs done by the run being resumed from the plan.
+ */
+static void skip_done_jobs(struct app_context *context, plan *plan)
+{
+    int size = plan_get_size(plan);
+    plan_retain(plan, context, select_undone_job);
+    int skipped = size - plan_get_size(plan);
+    if (skipped && !context->ndjson && !proc_is_silent(context->proc))
+        printf("Resuming: skipped %d of %d projects done before\n", skipped,
+                size);
+}
 
-    /* If we have not seen this workspace before, print out its description */
-    if (!proc_is_silent(context->proc) && context->last_name != name) {
-        printf("Workspace %s (name: %s)\n", path, name);
-        context->last_name = (char *)name;
+/*
+ * Prints out the jobs of the plan as JSON records.
+ */
+static void print_plan_json(struct app_context *context, plan *plan)
+{
+    for (int i = 0; i < plan_get_size(plan); i++) {
+        ndjson_write_job(context->ndjson, i,
+                plan_get_workspace_name(plan, plan_get_workspace(plan, i)),
+                plan_get_project(plan, i), plan_get_project_path(plan, i));
     }
-    proc_action(context->proc, path, project);
 }
 
 static void print_usage()
 {
     printf("Usage: octo [--def=<filename>] [--workspace=<name>] [--verbose]\n"
+           "            [--spawn=<strategy>] [--metrics-file=<filename>]\n"
+           "            [--rebuild-cache] [--where=<expression>]\n"
+           "            [--format=text|json] [--jobs=<n>] [--resume]\n"
+           "            [--log-level=warn|info|debug]\n"
            "            command [<args>]\n"
            "Commands:\n"
            "    pull\tPull the repositories\n"
            "    checkout\tCheck out out a branch\n"
            "    push\tPush the repositories\n"
            "    clone\tClone the repositories\n"
+           "    sync\tClone the missing repositories and pull the others\n"
            "    status\tPrint out the repositories status\n"
            "    list\tList the repository paths\n"
            "    path\tPrint the full path to repository\n"
-           "    exec\tExecute a command\n");
+           "    exec\tExecute a command\n"
+           "    stats\tPrint out the statistics of the past runs\n"
+           "    plan\tPrint out the jobs a command would run\n");
 }
 
 /*
@@ -91,6 +272,18 @@ static void print_usage()
  */
 static void destroy(struct app_context *context)
 {
+    if (context->metrics)
+        metrics_destroy(context->metrics);
+    if (context->history)
+        history_destroy(context->history);
+    if (context->summary)
+        summary_destroy(context->summary);
+    if (context->journal)
+        journal_destroy(context->journal);
+    if (context->where)
+        where_destroy(context->where);
+    if (context->ndjson)
+        ndjson_destroy(context->ndjson);
     proc_destroy(context->proc);
     logger_destroy(context->logger);
     config_destroy(context->config);
@@ -104,7 +297,13 @@ static void handle_error(void *inst, int err_code, const char *err_msg)
     (void)err_code; /* unused parameter */
     fflush(stdout);
     fprintf(stderr, "Error: %s\n", err_msg);
-    destroy((struct app_context *)inst);
+
+    /* Export the results collected so far, if any */
+    struct app_context *context = inst;
+    if (context->metrics && context->universe)
+        metrics_write(context->metrics,
+                config_get_metrics_file_name(context->config));
+    destroy(context);
     exit(EXIT_FAILURE);
 }
 
@@ -124,14 +323,57 @@ static int resolve_path(void *inst, const char *virt_path, char *dst, int len)
     return snprintf(dst, len, "%s%c%s", path, path_separator(), project);
 }
 
-int main(int argc, char *argv[])
+/*
+ * Prints out the statistics of the past runs recorded in the history.
+ */
+static void print_stats(struct app_context *context)
 {
-    struct app_context context;
+    const char *wname = proc_get_workspace_filter(context->proc);
+    if (!wname)
+        wname = config_get_workspace_name(context->config);
+    stats *stats = stats_new(context->universe, wname,
+            proc_get_action_filter(context->proc));
+    stats_load(stats, config_get_history_file_name(context->config));
+    stats_print(stats);
+    stats_destroy(stats);
+}
 
-    if (!proc_is_git_installed()) {
-        puts("Git is not installed!");
-        return EXIT_FAILURE;
+/*
+ * Initialises the universe options so that only the workspace the action
+ * needs is materialised. The alias buffer receives the alias of the path
+ * command.
+ */
+static void init_universe_options(struct app_context *context,
+        struct universe_options *options, char *alias)
+{
+    options->cache = true;
+    options->rebuild_cache = config_is_rebuild_cache(context->config);
+    options->workspace = config_get_workspace_name(context->config);
+    options->path_only = false;
+    const char *virt_path = proc_get_virtual_path(context->proc);
+    switch (proc_get_action(context->proc)) {
+    case PATH:
+        if (virt_path && strlen(virt_path) < MAX_PATH) {
+            strcpy(alias, virt_path);
+            char *sep = strchr(alias, '/');
+            if (sep)
+                *sep = 0;
+            options->workspace = alias;
+            options->path_only = true;
+        }
+        break;
+    case STATS:
+        if (proc_get_workspace_filter(context->proc))
+            options->workspace = proc_get_workspace_filter(context->proc);
+        break;
+    default:
+        break;
     }
+}
+
+int main(int argc, char *argv[])
+{
+    struct app_context context;
 
     if (argc == 1) {
         print_usage();
@@ -147,36 +389,117 @@ int main(int argc, char *argv[])
     context.config = config_new();
     context.logger = logger_create(-1, stdout);
     context.proc = proc_new(context.logger, context.config);
+    context.universe = NULL;
+    context.metrics = NULL;
+    context.history = NULL;
+    context.summary = NULL;
+    context.journal = NULL;
+    context.where = NULL;
+    context.ndjson = NULL;
+    context.plan = NULL;
     context.last_name = NULL;
 
-    /* Assign the error handler function */
+    /* Assign the error and result handler functions */
     proc_set_err_handler(context.proc, &context, handle_error);
+    proc_set_result_handler(context.proc, &context, handle_result);
 
     const char *err_msg = config_parse_cmd_line(context.config, argc, argv);
+    if (!err_msg) {
+        logger_set_level(
+                context.logger, config_get_log_level(context.config));
+        xsystem_set_strategy(config_get_spawn_strategy(context.config));
+        if (config_get_metrics_file_name(context.config)) {
+            context.metrics = metrics_new();
+            proc_set_upstream_tracking(context.proc, true);
+        }
+        if (config_get_format(context.config) == FORMAT_JSON) {
+            context.ndjson = ndjson_new(STDOUT_FILENO);
+            proc_set_upstream_tracking(context.proc, true);
+        }
+        /* Compile the selection expression once for all the jobs */
+        if (config_get_where(context.config))
+            context.where =
+                    where_new(config_get_where(context.config), &err_msg);
+    }
 
     /* Parse the command line parameters */
-    if (!err_msg && proc_parse_cmd_line(context.proc, argc, argv)) {
+    bool parsed = !err_msg && proc_parse_cmd_line(context.proc, argc, argv);
+
+    /* Only look for Git if the command is going to run it */
+    if (parsed && proc_is_git_required(context.proc) &&
+            !proc_is_git_installed()) {
+        parsed = false;
+        err_msg = "Git is not installed";
+    }
+
+    if (parsed) {
         /*
          * Instantiate the workspace "universe" and parse the declaration
          * file
          */
-        context.universe = universe_new(context.logger,
-                config_get_def_file_name(context.config), &context,
+        struct universe_options options;
+        char alias[MAX_PATH];
+        init_universe_options(&context, &options, alias);
+        context.universe = universe_new_ex(context.logger,
+                config_get_def_file_name(context.config), &options, &context,
                 handle_error);
         /*
          * Perform a single or repetitive task (by visiting each and every
          * entry contained by universe)
          */
-        if (proc_is_repetitive(context.proc))
-            universe_accept(context.universe, &context, visit);
-        else
+        if (proc_get_action(context.proc) == STATS) {
+            print_stats(&context);
+        } else if (proc_get_action(context.proc) == PLAN ||
+                proc_is_repetitive(context.proc)) {
+            /* Compile the jobs of the selected workspaces */
+            plan *plan = plan_new(context.universe,
+                    config_get_workspace_name(context.config));
+            if (context.where)
+                plan_retain(plan, &context, select_job);
+            if (proc_get_action(context.proc) == PLAN) {
+                if (context.ndjson)
+                    print_plan_json(&context, plan);
+                else
+                    plan_print(plan, stdout);
+            } else {
+                /*
+                 * Record the results in the history (if it can be opened)
+                 * and keep track of the projects the action failed on
+                 */
+                if (proc_get_action(context.proc) != LIST) {
+                    context.history = history_new(
+                            config_get_history_file_name(context.config));
+                    context.summary = summary_new();
+                    /* Skip the projects done by the run being resumed */
+                    context.journal = open_journal(&context, argc, argv);
+                    if (context.journal && config_is_resume(context.config))
+                        skip_done_jobs(&context, plan);
+                }
+                /* Listing is not worth a process per project */
+                if (config_get_jobs(context.config) > 1 &&
+                        proc_get_action(context.proc) != LIST) {
+                    if (!run_plan_concurrently(&context, plan))
+                        err_msg = "Some of the jobs were aborted";
+                } else
+                    run_plan(&context, plan);
+                /* The JSON records carry the errors themselves */
+                if (context.summary && !context.ndjson)
+                    summary_print(context.summary, stdout);
+            }
+            plan_destroy(plan);
+        } else
             proc_single_action(context.proc, &context, resolve_path);
 
+        if (context.metrics &&
+                !metrics_write(context.metrics,
+                        config_get_metrics_file_name(context.config)))
+            err_msg = "Cannot write metrics file";
+
         /* Release the claimed resources */
         universe_destroy(context.universe);
         context.universe = NULL;
 
-    } else {
+    } else if (!err_msg) {
         err_msg = proc_get_error_message(context.proc);
     }
 
@@ -187,6 +510,12 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    /* The action carried on past the projects it failed on */
+    bool failed =
+            context.summary && summary_get_failures(context.summary) > 0;
+    /* There is nothing left to resume */
+    if (context.journal && !failed)
+        journal_discard(context.journal);
     destroy(&context);
-    return EXIT_SUCCESS;
+    return failed ? EXIT_PARTIAL_FAILURE : EXIT_SUCCESS;
 }
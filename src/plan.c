@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * plan.c
+ */
+#include "plan.h"
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "strpool.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+DECLARE_VECTOR(index_vector, int)
+DECLARE_VECTOR(name_vector, const char *)
+
+struct plan_st {
+    /* The jobs, one item per job in each vector */
+    struct index_vector job_workspaces;
+    struct name_vector projects;
+    struct name_vector project_paths;
+    /* The workspaces, one item per workspace in each vector */
+    struct name_vector workspace_names;
+    struct name_vector workspace_paths;
+    /* The name of the only workspace to compile or NULL */
+    const char *workspace_filter;
+    /* The last workspace visited and whether it passed the filter */
+    const char *last_name;
+    bool selected;
+    str_pool *paths;
+};
+
+static void add_job(
+        void *inst, const char *name, const char *path, const char *project)
+{
+    plan *obj = inst;
+    /* The names are interned, so a new workspace has a different pointer */
+    if (obj->last_name != name) {
+        obj->last_name = name;
+        obj->selected = !obj->workspace_filter ||
+                !strcmp(obj->workspace_filter, name);
+        if (obj->selected) {
+            name_vector_push(&obj->workspace_names, name);
+            name_vector_push(&obj->workspace_paths, path);
+        }
+    }
+    if (!obj->selected)
+        return;
+    int w = obj->workspace_names.size - 1;
+
+    char project_path[MAX_PATH];
+    snprintf(project_path, MAX_PATH, "%s%c%s", path, path_separator(),
+            project);
+    index_vector_push(&obj->job_workspaces, w);
+    name_vector_push(&obj->projects, project);
+    name_vector_push(
+            &obj->project_paths, str_pool_intern(obj->paths, project_path));
+}
+
+plan *plan_new(universe *universe, const char *workspace)
+{
+    plan *obj = malloc(sizeof(struct plan_st));
+    index_vector_init(&obj->job_workspaces);
+    name_vector_init(&obj->projects);
+    name_vector_init(&obj->project_paths);
+    name_vector_init(&obj->workspace_names);
+    name_vector_init(&obj->workspace_paths);
+    obj->workspace_filter = workspace;
+    obj->last_name = NULL;
+    obj->selected = false;
+    obj->paths = str_pool_new();
+    universe_accept(universe, obj, add_job);
+    return obj;
+}
+
+int plan_get_size(plan *obj)
+{
+    return obj->projects.size;
+}
+
+int plan_get_workspace(plan *obj, int job)
+{
+    return obj->job_workspaces.items[job];
+}
+
+const char *plan_get_project(plan *obj, int job)
+{
+    return obj->projects.items[job];
+}
+
+const char *plan_get_project_path(plan *obj, int job)
+{
+    return obj->project_paths.items[job];
+}
+
+int plan_get_workspace_count(plan *obj)
+{
+    return obj->workspace_names.size;
+}
+
+const char *plan_get_workspace_name(plan *obj, int workspace)
+{
+    return obj->workspace_names.items[workspace];
+}
+
+const char *plan_get_workspace_path(plan *obj, int workspace)
+{
+    return obj->workspace_paths.items[workspace];
+}
+
+void plan_retain(plan *obj, void *inst, bool (*keep)(void *, plan *, int))
+{
+    /*
+     * Compact the jobs and workspaces in place. The indices written never
+     * exceed the one being read, so the job passed to the function is still
+     * intact.
+     */
+    int size = 0;
+    int last_workspace = -1;
+    int w = -1;
+    for (int i = 0; i < obj->projects.size; i++) {
+        if (!keep(inst, obj, i))
+            continue;
+        int workspace = obj->job_workspaces.items[i];
+        if (workspace != last_workspace) {
+            last_workspace = workspace;
+            w++;
+            obj->workspace_names.items[w] =
+                    obj->workspace_names.items[workspace];
+            obj->workspace_paths.items[w] =
+                    obj->workspace_paths.items[workspace];
+        }
+        obj->job_workspaces.items[size] = w;
+        obj->projects.items[size] = obj->projects.items[i];
+        obj->project_paths.items[size] = obj->project_paths.items[i];
+        size++;
+    }
+    obj->job_workspaces.size = obj->projects.size = size;
+    obj->project_paths.size = size;
+    obj->workspace_names.size = obj->workspace_paths.size = w + 1;
+}
+
+void plan_print(plan *obj, FILE *file)
+{
+    for (int i = 0; i < obj->projects.size; i++) {
+        fprintf(file, "%d\t%s\t%s\t%s\n", i,
+                obj->workspace_names.items[obj->job_workspaces.items[i]],
+                obj->projects.items[i], obj->project_paths.items[i]);
+    }
+}
+
+void plan_destroy(plan *obj)
+{
+    index_vector_destroy(&obj->job_workspaces);
+    name_vector_destroy(&obj->projects);
+    name_vector_destroy(&obj->project_paths);
+    name_vector_destroy(&obj->workspace_names);
+    name_vector_destroy(&obj->workspace_paths);
+    str_pool_destroy(obj->paths);
+    free(obj);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * plan.h
+ *
+ * Flat job plan compiled from the universe. The jobs are kept as a
+ * structure of arrays in the order the universe lists them, so executors
+ * can index and partition them without walking the workspaces again.
+ */
+
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "universe.h"
+
+typedef struct plan_st plan;
+
+/*
+ * Compiles the projects of the universe into jobs, optionally only those of
+ * the named workspace (if not NULL). The plan borrows the names from the
+ * universe, which has to outlive it.
+ */
+plan *plan_new(universe *, const char *);
+
+/*
+ * Returns the number of jobs.
+ */
+int plan_get_size(plan *);
+
+/*
+ * Returns the index of the workspace of the specified job.
+ */
+int plan_get_workspace(plan *, int);
+
+/*
+ * Returns the project name of the specified job.
+ */
+const char *plan_get_project(plan *, int);
+
+/*
+ * Returns the full path to the project of the specified job.
+ */
+const char *plan_get_project_path(plan *, int);
+
+/*
+ * Returns the number of workspaces having jobs in the plan.
+ */
+int plan_get_workspace_count(plan *);
+
+/*
+ * Returns the name of the workspace with the specified index.
+ */
+const char *plan_get_workspace_name(plan *, int);
+
+/*
+ * Returns the path to the workspace with the specified index.
+ */
+const char *plan_get_workspace_path(plan *, int);
+
+/*
+ * Keeps only the jobs the specified function returns true for, preserving
+ * their order. Workspaces left without jobs are dropped as well.
+ */
+void plan_retain(plan *, void *, bool (*)(void *, plan *, int));
+
+/*
+ * Prints out the jobs one per line.
+ */
+void plan_print(plan *, FILE *);
+
+void plan_destroy(plan *);
+
+#endif /* PLAN_H_ */
@@ -33,31 +33,42 @@
  */
 
 #include "proc.h"
+#include <errno.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include "cmdline.h"
+#include "containers.h"
 #include "decorations.h"
 #include "errpublisher.h"
 #include "logger.h"
+#include "ndjson.h"
 #include "utils.h"
 #include "xsystem.h"
+#include "alloctrace.h"
 
 #define MAX_PATH 1024
 #define CHAR_BUFFER_LEN 8192
 #define CMD_BUFFER_LEN MAX_PATH
+/* Head of the command output kept in the results */
+#define RESULT_OUTPUT_LEN 1024
+/* The longest error message of a project */
+#define RESULT_ERROR_LEN 256
 
-#define CMD_CURR_BRANCH "git rev-parse --abbrev-ref HEAD"
-#define CMD_STATUS "git status --porcelain"
+/* Git arguments */
+#define CMD_CURR_BRANCH "rev-parse --abbrev-ref HEAD"
 
 static const char *INVALID_ARGUMENTS = "Invalid argument(s) in command line";
 static const char *UNKNOWN_BRANCH = "Branch not specified in checkout command";
 static const char *UNKNOWN_REPOSITORY =
         "Repository not specified in the clone command";
+static const char *UNKNOWN_SYNC_REPOSITORY =
+        "Repository not specified in the sync command";
 static const char *INVALID_BRANCH_NAME = "Invalid branch name";
 static const char *INVALID_PROJECT_NAME = "Invalid project name";
 
@@ -113,8 +124,11 @@ static bool is_safe_url_prefix(const char *url)
     }
     return true;
 }
+DECLARE_VECTOR(text, char)
+
 static const char *UNKNOWN_VIRT_PATH = "Virtual path is not specified";
 static const char *UNKNOWN_COMMAND = "Unknown command";
+static const char *UNKNOWN_ACTION = "Unknown action in stats command";
 
 struct proc_st {
     logger *logger;
@@ -130,39 +144,140 @@ struct proc_st {
     char *cmd_buffer;
     err_publisher *err_publisher;
     bool silent;
+    const char *workspace_filter;
+    enum action action_filter;
+    struct proc_result result;
+    void *result_handler_inst;
+    void (*handle_result)(void *, const struct proc_result *);
+    bool track_upstream;
+    char current_branch[MAX_PATH];
+    char output[RESULT_OUTPUT_LEN];
+    char error[RESULT_ERROR_LEN];
+    /* What is printed out about the project, written at once when done */
+    struct text record;
 };
 
-#ifdef DEBUG
-static const char *action_to_string(enum action action)
+const char *proc_action_name(enum action action)
 {
     switch (action) {
     case PULL:
-        return "PULL";
+        return "pull";
     case PUSH:
-        return "PUSH";
+        return "push";
     case CHECKOUT:
-        return "CHECKOUT";
+        return "checkout";
     case CLONE:
-        return "CLONE";
+        return "clone";
     case STATUS:
-        return "STATUS";
+        return "status";
     case LIST:
-        return "LIST";
+        return "list";
+    case EXEC:
+        return "exec";
     case PATH:
-        return "PATH";
+        return "path";
+    case STATS:
+        return "stats";
+    case PLAN:
+        return "plan";
+    case SYNC:
+        return "sync";
     default:
-        return "UNKNOWN";
+        return "unknown";
+    }
+}
+
+enum action proc_parse_action_name(const char *name)
+{
+    for (enum action a = PULL; a <= SYNC; a++) {
+        if (!strcmp(name, proc_action_name(a)))
+            return a;
     }
+    return UNKNOWN;
 }
-#endif
+
+/*
+ * The absolute path to Git, looked up on first use.
+ */
+static enum { GIT_UNKNOWN, GIT_FOUND, GIT_MISSING } git_state = GIT_UNKNOWN;
+static char git_path[MAX_PATH];
 
 bool proc_is_git_installed()
 {
-    bool result;
-    struct char_buffer *char_buffer = char_buffer_new(128);
-    result = !xsystem("git version 2>&1", char_buffer, false);
-    char_buffer_destroy(char_buffer);
-    return result;
+    if (git_state == GIT_UNKNOWN) {
+        git_state = find_executable("git", git_path, MAX_PATH) ? GIT_FOUND
+                                                               : GIT_MISSING;
+    }
+    return git_state == GIT_FOUND;
+}
+
+const char *proc_git_command(char *dst, const char *args)
+{
+    if (proc_is_git_installed() && !strchr(git_path, '\''))
+        snprintf(dst, PROC_GIT_CMD_LEN, "'%s' %s", git_path, args);
+    else
+        snprintf(dst, PROC_GIT_CMD_LEN, "git %s", args);
+    return dst;
+}
+
+bool proc_is_git_required(proc *obj)
+{
+    switch (obj->action) {
+    case PULL:
+    case PUSH:
+    case CHECKOUT:
+    case CLONE:
+    case STATUS:
+    case SYNC:
+        return true;
+    case EXEC:
+        /* The command itself need not be Git but the upstream probe is */
+        return obj->track_upstream;
+    default:
+        return false;
+    }
+}
+
+static inline bool is_json(proc *obj)
+{
+    return config_get_format(obj->config) == FORMAT_JSON;
+}
+
+static void print(proc *obj, const char *s)
+{
+    text_append(&obj->record, s, strlen(s));
+}
+
+/*
+ * Writes out what has been printed out about the project with a single
+ * write.
+ */
+static void flush_record(proc *obj)
+{
+    if (!obj->record.size)
+        return;
+    /* Keep the order with what may have been printed out through stdio */
+    fflush(stdout);
+    write_fully(STDOUT_FILENO, obj->record.items, obj->record.size);
+    text_clear(&obj->record);
+}
+
+/*
+ * Fails the action on the project with the specified error. Unlike the
+ * published errors it does not stop the actions on the other projects.
+ */
+static void fail(proc *obj, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(obj->error, RESULT_ERROR_LEN, fmt, args);
+    va_end(args);
+    obj->result.error = obj->error;
+    if (!is_json(obj)) {
+        print(obj, "Error: ");
+        print(obj, obj->error);
+        print(obj, "\n");
+    }
 }
 
 /*
@@ -178,6 +293,8 @@ static inline void reset(proc *obj)
     obj->dry_run = false;
     obj->error_message = NULL;
     obj->silent = false;
+    obj->workspace_filter = NULL;
+    obj->action_filter = UNKNOWN;
 }
 
 proc *proc_new(logger *logger, config *config)
@@ -189,6 +306,10 @@ proc *proc_new(logger *logger, config *config)
     obj->config = config;
     obj->char_buffer = char_buffer_new(CHAR_BUFFER_LEN);
     obj->cmd_buffer = malloc(CMD_BUFFER_LEN);
+    obj->err_publisher = NULL;
+    obj->handle_result = NULL;
+    obj->track_upstream = false;
+    text_init(&obj->record);
     reset(obj);
     return obj;
 }
@@ -199,6 +320,18 @@ void proc_set_err_handler(proc *obj, void *err_handler_inst,
     obj->err_publisher = err_publisher_new(err_handler_inst, handle_err);
 }
 
+void proc_set_result_handler(proc *obj, void *result_handler_inst,
+        void (*handle_result)(void *, const struct proc_result *))
+{
+    obj->result_handler_inst = result_handler_inst;
+    obj->handle_result = handle_result;
+}
+
+void proc_set_upstream_tracking(proc *obj, bool track_upstream)
+{
+    obj->track_upstream = track_upstream;
+}
+
 bool proc_parse_cmd_line(proc *obj, int argc, char *argv[])
 {
     reset(obj);
@@ -228,6 +361,13 @@ bool proc_parse_cmd_line(proc *obj, int argc, char *argv[])
         }
         obj->action = CLONE;
         obj->repository = argv[i++];
+    } else if (!strcmp(argv[i], "sync")) {
+        if (++i >= argc || is_opt(argv[i])) {
+            obj->error_message = UNKNOWN_SYNC_REPOSITORY;
+            return false;
+        }
+        obj->action = SYNC;
+        obj->repository = argv[i++];
     } else if (!strcmp(argv[i], "status")) {
         obj->action = STATUS;
         i++;
@@ -262,6 +402,31 @@ bool proc_parse_cmd_line(proc *obj, int argc, char *argv[])
         obj->action = PATH;
         obj->repetitive = false;
         obj->virtual_path = argv[i++];
+    } else if (!strcmp(argv[i], "plan")) {
+        obj->action = PLAN;
+        obj->repetitive = false;
+        obj->silent = true;
+        i++;
+    } else if (!strcmp(argv[i], "stats")) {
+        obj->action = STATS;
+        obj->repetitive = false;
+        obj->silent = true;
+        for (i++; i < argc && is_opt(argv[i]); i++) {
+            char *value = strchr(argv[i], '=');
+            if (!value || !*++value)
+                break;
+            if (equal_opts(argv[i], "--workspace") ||
+                    equal_opts(argv[i], "-w")) {
+                obj->workspace_filter = value;
+            } else if (equal_opts(argv[i], "--action")) {
+                obj->action_filter = proc_parse_action_name(value);
+                if (obj->action_filter == UNKNOWN) {
+                    obj->error_message = UNKNOWN_ACTION;
+                    return false;
+                }
+            } else
+                break;
+        }
     } else {
         obj->error_message = UNKNOWN_COMMAND;
         return false;
@@ -271,47 +436,88 @@ bool proc_parse_cmd_line(proc *obj, int argc, char *argv[])
         obj->error_message = INVALID_ARGUMENTS;
         return false;
     }
+    /* Nothing but the records is printed out in the JSON format */
+    if (is_json(obj))
+        obj->silent = true;
     return true;
 }
 
-static int exec(proc *obj, const char *path, const char *project,
+/*
+ * Counts the commits the current branch is ahead of and behind its upstream.
+ */
+static void probe_upstream(proc *obj)
+{
+    struct char_buffer *buff = obj->char_buffer;
+    char cmd[PROC_GIT_CMD_LEN];
+    char_buffer_reset(buff);
+    if (xsystem(proc_git_command(cmd, PROC_CMD_AHEAD_BEHIND " 2>/dev/null"),
+                buff, false))
+        return;
+    /* The output is "<ahead>\t<behind>\n" */
+    char counts[32];
+    int len = char_buffer_len(buff);
+    if (len >= (int)sizeof(counts))
+        return;
+    memcpy(counts, buff->buffer + buff->position, len);
+    counts[len] = 0;
+    if (sscanf(counts, "%d %d", &obj->result.ahead, &obj->result.behind) != 2)
+        obj->result.ahead = obj->result.behind = -1;
+}
+
+/*
+ * Keeps the head of the command output for the JSON records and the failure
+ * summary.
+ */
+static void keep_output(proc *obj, long long bytes_read)
+{
+    struct char_buffer *buff = obj->char_buffer;
+    int len = char_buffer_len(buff);
+    if (len > RESULT_OUTPUT_LEN)
+        len = RESULT_OUTPUT_LEN;
+    memcpy(obj->output, buff->buffer + buff->position, len);
+    obj->result.output = obj->output;
+    obj->result.output_len = len;
+    obj->result.output_truncated = xsystem_get_bytes_read() - bytes_read > len;
+}
+
+/*
+ * Runs the command in the specified directory, which is a project directory
+ * unless the project flag is false.
+ */
+static int exec(proc *obj, const char *dir_path, bool project,
         const char *command, void (*run_before)(proc *),
         void (*run_after)(proc *))
 {
     int result = -1;
     char cwd[MAX_PATH];
-    if (getcwd(cwd, sizeof(cwd)) != NULL) {
-        const char *dir_path;
-        if (project) {
-            char full_path[MAX_PATH];
-            snprintf(full_path, MAX_PATH, "%s%c%s", path, path_separator(),
-                    project);
-            dir_path = full_path;
+    if (getcwd(cwd, sizeof(cwd)) != NULL && !chdir(dir_path)) {
+        /* Run the "pre" task if provided */
+        if (run_before)
+            run_before(obj);
+
+        /* Execute the command unless we are in the dry run or verbose
+         * mode
+         */
+        DEBUG_LOG(obj->logger, "exec: %s\n", command);
+        bool verbose = config_is_verbose(obj->config) && !is_json(obj);
+        char_buffer_reset(obj->char_buffer);
+        long long bytes_read = xsystem_get_bytes_read();
+        /* The output of the command is passed through in the verbose mode */
+        if (verbose)
+            flush_record(obj);
+        if (!obj->dry_run || verbose) {
+            result = xsystem(command, obj->char_buffer, verbose);
+            keep_output(obj, bytes_read);
         } else
-            dir_path = path;
-
-        if (!chdir(dir_path)) {
-            /* Run the "pre" task if provided */
-            if (run_before)
-                run_before(obj);
-
-            /* Execute the command unless we are in the dry run or verbose
-             * mode
-             */
-            DEBUG_LOG(obj->logger, "exec: %s\n", obj->cmd_buffer);
-            bool verbose = config_is_verbose(obj->config);
-            char_buffer_reset(obj->char_buffer);
-            if (!obj->dry_run || verbose)
-                result = xsystem(command, obj->char_buffer, verbose);
-            else
-                result = 0;
-            DEBUG_LOG(obj->logger, "exec: result=%d\n", result);
-
-            /* Run the "post" task if provided */
-            if (run_after)
-                run_after(obj);
-            chdir(cwd);
-        }
+            result = 0;
+        DEBUG_LOG(obj->logger, "exec: result=%d\n", result);
+
+        /* Run the "post" task if provided */
+        if (run_after)
+            run_after(obj);
+        if (project && obj->track_upstream)
+            probe_upstream(obj);
+        chdir(cwd);
     }
     return result;
 }
@@ -323,26 +529,41 @@ static void print_branch_name(proc *obj)
 {
     struct char_buffer *buff = obj->char_buffer;
     char_buffer_reset(buff);
-    putchar('{');
-    bool colour = config_is_colour(obj->config);
-    if (colour)
-        printf(ANSI_COLOR_CYAN);
-    if (!xsystem(CMD_CURR_BRANCH " 2>&1", buff, false)) {
+    char cmd[PROC_GIT_CMD_LEN];
+    bool found =
+            !xsystem(proc_git_command(cmd, CMD_CURR_BRANCH " 2>&1"), buff, false);
+    if (found) {
         /* Trim the LF */
         buff->limit--;
+        int len = char_buffer_len(buff);
+        if (len >= MAX_PATH)
+            len = MAX_PATH - 1;
+        memcpy(obj->current_branch, buff->buffer + buff->position, len);
+        obj->current_branch[len] = 0;
+        obj->result.branch = obj->current_branch;
+    }
+    if (is_json(obj))
+        return;
+
+    print(obj, "{");
+    bool colour = config_is_colour(obj->config);
+    if (colour)
+        print(obj, ANSI_COLOR_CYAN);
+    if (found) {
         if (colour) {
-            printf(!strncmp("master", buff->buffer + buff->position,
-                           char_buffer_len(buff))
-                            ? ANSI_COLOR_CYAN
-                            : ANSI_COLOR_CYAN_BR);
+            print(obj, !strncmp("master", buff->buffer + buff->position,
+                               char_buffer_len(buff))
+                               ? ANSI_COLOR_CYAN
+                               : ANSI_COLOR_CYAN_BR);
         }
-        char_buffer_print(buff);
+        text_append(&obj->record, buff->buffer + buff->position,
+                char_buffer_len(buff));
         if (colour)
-            printf(ANSI_COLOR_RESET);
+            print(obj, ANSI_COLOR_RESET);
     } else {
-        printf("???");
+        print(obj, "???");
     }
-    putchar('}');
+    print(obj, "}");
 }
 
 /*
@@ -354,154 +575,246 @@ static void print_branch_name_chg(proc *obj)
     print_branch_name(obj);
     struct char_buffer *buff = obj->char_buffer;
     char_buffer_reset(buff);
-    int result = xsystem(CMD_STATUS " 2>&1", buff, false);
+    char cmd[PROC_GIT_CMD_LEN];
+    int result = xsystem(
+            proc_git_command(cmd, PROC_CMD_STATUS " 2>&1"), buff, false);
+    if (!result)
+        obj->result.dirty = buff->limit - buff->position > 0;
+    if (is_json(obj))
+        return;
     if (!result && buff->limit - buff->position > 0) {
         bool colour = config_is_colour(obj->config);
         if (colour)
-            printf(ANSI_COLOR_RED);
-        printf(" Changed!");
+            print(obj, ANSI_COLOR_RED);
+        print(obj, " Changed!");
         if (colour)
-            printf(ANSI_COLOR_RESET);
+            print(obj, ANSI_COLOR_RESET);
     }
     if (config_is_verbose(obj->config))
-        putchar('\n');
+        print(obj, "\n");
+}
+
+/*
+ * Terminates the line describing the action on a project.
+ */
+static void end_line(proc *obj)
+{
+    if (!is_json(obj))
+        print(obj, "\n");
 }
 
 static void print_action(proc *obj, const char *action, const char *project)
 {
-    printf(" · %s ", action);
+    if (is_json(obj))
+        return;
+    print(obj, " · ");
+    print(obj, action);
+    print(obj, " ");
     bool color = config_is_colour(obj->config);
     if (color)
-        printf(ANSI_COLOR_YELLOW);
-    printf("%s ", project);
+        print(obj, ANSI_COLOR_YELLOW);
+    print(obj, project);
+    print(obj, " ");
     if (color)
-        printf(ANSI_COLOR_RESET);
+        print(obj, ANSI_COLOR_RESET);
 }
 
-static void pull(proc *obj, const char *path, const char *project)
+static int pull(proc *obj, const char *project_path, const char *project)
 {
     print_action(obj, "Pulling", project);
-    exec(obj, path, project, "git pull -p 2>&1", print_branch_name_chg, NULL);
-    putchar('\n');
+    char cmd[PROC_GIT_CMD_LEN];
+    int result = exec(obj, project_path, true,
+            proc_git_command(cmd, "pull -p 2>&1"), print_branch_name_chg, NULL);
+    end_line(obj);
+    return result;
 }
 
-static void checkout(
-        proc *obj, const char *path, const char *project, const char *branch)
+static int checkout(proc *obj, const char *project_path, const char *project,
+        const char *branch)
 {
     if (!is_valid_branch_name(branch)) {
         if (obj->err_publisher) {
             err_publisher_fire(obj->err_publisher, -1, INVALID_BRANCH_NAME);
         }
-        return;
+        return -1;
     }
     
     print_action(obj, "Checking out", project);
-    char cmd[MAX_PATH];
-    snprintf(cmd, MAX_PATH, "git checkout %s 2>&1", branch);
-    exec(obj, path, project, cmd, NULL, print_branch_name_chg);
-    putchar('\n');
+    char args[MAX_PATH], cmd[PROC_GIT_CMD_LEN];
+    snprintf(args, MAX_PATH, "checkout %s 2>&1", branch);
+    proc_git_command(cmd, args);
+    int result =
+            exec(obj, project_path, true, cmd, NULL, print_branch_name_chg);
+    end_line(obj);
+    return result;
 }
 
-static void push(proc *obj, const char *path, const char *project)
+static int push(proc *obj, const char *project_path, const char *project)
 {
     print_action(obj, "Pushing", project);
-    exec(obj, path, project, "git push 2>&1", print_branch_name_chg, NULL);
-    putchar('\n');
+    char cmd[PROC_GIT_CMD_LEN];
+    int result = exec(obj, project_path, true,
+            proc_git_command(cmd, "push 2>&1"), print_branch_name_chg, NULL);
+    end_line(obj);
+    return result;
 }
 
-static void clone(proc *obj, const char *path, const char *project)
+static int clone(proc *obj, const char *path, const char *project)
 {
     if (!is_valid_project_name(project)) {
-        if (obj->err_publisher) {
-            err_publisher_fire(obj->err_publisher, -1, INVALID_PROJECT_NAME);
-        }
-        return;
+        fail(obj, "%s", INVALID_PROJECT_NAME);
+        return -1;
     }
     
     if (!is_safe_url_prefix(obj->repository)) {
         if (obj->err_publisher) {
             err_publisher_fire(obj->err_publisher, -1, "Invalid repository URL");
         }
-        return;
+        return -1;
     }
     
     print_action(obj, "Cloning", project);
-    putchar('\n');
-
-    char cmd[MAX_PATH];
-    snprintf(cmd, MAX_PATH, "git clone %s%s 2>&1", obj->repository, project);
-    int result = exec(obj, path, NULL, cmd, NULL, NULL);
-    if (result && obj->err_publisher) {
-        err_publisher_fire(
-                obj->err_publisher, result, "Failed to clone '%s'", project);
+    end_line(obj);
+
+    char args[MAX_PATH], cmd[PROC_GIT_CMD_LEN];
+    snprintf(args, MAX_PATH, "clone %s%s 2>&1", obj->repository, project);
+    proc_git_command(cmd, args);
+    int result = exec(obj, path, false, cmd, NULL, NULL);
+    if (result)
+        fail(obj, "Failed to clone '%s'", project);
+    return result;
+}
+
+/*
+ * Clones the project unless its directory exists, and fast-forwards it
+ * otherwise.
+ */
+static int sync_project(proc *obj, const char *path, const char *project,
+        const char *project_path)
+{
+    struct stat st;
+    if (stat(project_path, &st)) {
+        if (errno == ENOENT)
+            return clone(obj, path, project);
+        fail(obj, "Cannot access '%s': %s", project_path, strerror(errno));
+        return -1;
     }
+    if (!S_ISDIR(st.st_mode)) {
+        fail(obj, "'%s' is not a directory", project_path);
+        return -1;
+    }
+    print_action(obj, "Syncing", project);
+    char cmd[PROC_GIT_CMD_LEN];
+    int result = exec(obj, project_path, true,
+            proc_git_command(cmd, "pull --ff-only -p 2>&1"),
+            print_branch_name_chg, NULL);
+    end_line(obj);
+    return result;
 }
 
-static void status(proc *obj, const char *path, const char *project)
+static int status(proc *obj, const char *project_path, const char *project)
 {
     print_action(obj, "Found", project);
     bool prev_dry_run = obj->dry_run;
     obj->dry_run = true;
-    int result = exec(
-            obj, path, project, "git status 2>&1", print_branch_name_chg, NULL);
-    putchar('\n');
+    char cmd[PROC_GIT_CMD_LEN];
+    int result = exec(obj, project_path, true,
+            proc_git_command(cmd, "status 2>&1"), print_branch_name_chg, NULL);
+    end_line(obj);
     obj->dry_run = prev_dry_run;
-    if (result && obj->err_publisher) {
-        err_publisher_fire(obj->err_publisher, result,
-                "Failed to retrieve status of '%s'", project);
-    }
+    if (result)
+        fail(obj, "Failed to retrieve status of '%s'", project);
+    return result;
 }
 
-static void list(proc *obj, const char *path, const char *project)
+static void list(proc *obj, const char *project_path)
 {
-    (void)obj; /* unused parameter */
-    printf("%s%c%s\n", path, path_separator(), project);
+    /* The JSON record is written by the result handler, and the paths are
+     * left to stdio buffering as there is one short line per project */
+    if (!is_json(obj))
+        puts(project_path);
 }
 
-static void exec_command(proc *obj, const char *path, const char *project)
+static int exec_command(proc *obj, const char *project_path)
 {
-    exec(obj, path, project, obj->cmd_buffer, NULL, NULL);
+    /* The JSON records report the branch and changes of every project */
+    return exec(obj, project_path, true, obj->cmd_buffer,
+            is_json(obj) ? print_branch_name_chg : NULL, NULL);
 }
 
 static void print_path(proc *obj, const char *path)
 {
-    (void)obj; /* unused parameter */
-    puts(path);
+    if (is_json(obj)) {
+        ndjson *out = ndjson_new(STDOUT_FILENO);
+        ndjson_write_path(out, path);
+        ndjson_destroy(out);
+    } else {
+        print(obj, path);
+        print(obj, "\n");
+        flush_record(obj);
+    }
 }
 
-void proc_action(proc *obj, const char *path, const char *project)
+void proc_action(proc *obj, const char *path, const char *project,
+        const char *project_path)
 {
     if (!proc_is_repetitive(obj))
         return;
 
     DEBUG_LOG(obj->logger, "git_action: action='%s', path='%s', project='%s'\n",
-            action_to_string(obj->action), path, project);
+            proc_action_name(obj->action), path, project);
+
+    struct proc_result *result = &obj->result;
+    result->action = obj->action;
+    result->path = path;
+    result->project = project;
+    result->project_path = project_path;
+    result->dirty = result->ahead = result->behind = -1;
+    result->branch = result->output = NULL;
+    result->output_len = 0;
+    result->output_truncated = false;
+    result->error = NULL;
+    long long start = clock_ns();
+    long long bytes_read = xsystem_get_bytes_read();
+    int status_code = 0;
 
     switch (obj->action) {
     case PULL:
-        pull(obj, path, project);
+        status_code = pull(obj, project_path, project);
         break;
     case CHECKOUT:
-        checkout(obj, path, project, obj->branch);
+        status_code = checkout(obj, project_path, project, obj->branch);
         break;
     case PUSH:
-        push(obj, path, project);
+        status_code = push(obj, project_path, project);
         break;
     case CLONE:
-        clone(obj, path, project);
+        status_code = clone(obj, path, project);
         break;
     case STATUS:
-        status(obj, path, project);
+        status_code = status(obj, project_path, project);
+        break;
+    case SYNC:
+        status_code = sync_project(obj, path, project, project_path);
         break;
     case LIST:
-        list(obj, path, project);
+        /* Listing does not act on the repository, the result only tells
+         * where it is */
+        list(obj, project_path);
         break;
     case EXEC:
-        exec_command(obj, path, project);
+        status_code = exec_command(obj, project_path);
         break;
     default:
-        break;
+        return;
     }
+
+    result->exit_code = xsystem_exit_code(status_code);
+    result->duration_ns = clock_ns() - start;
+    result->bytes = xsystem_get_bytes_read() - bytes_read;
+    flush_record(obj);
+    if (obj->handle_result)
+        obj->handle_result(obj->result_handler_inst, result);
 }
 
 void proc_single_action(proc *obj, void *inst,
@@ -536,6 +849,21 @@ enum action proc_get_action(proc *obj)
     return obj->action;
 }
 
+const char *proc_get_workspace_filter(proc *obj)
+{
+    return obj->workspace_filter;
+}
+
+const char *proc_get_virtual_path(proc *obj)
+{
+    return obj->virtual_path;
+}
+
+enum action proc_get_action_filter(proc *obj)
+{
+    return obj->action_filter;
+}
+
 bool proc_is_repetitive(proc *obj)
 {
     return obj->repetitive;
@@ -555,6 +883,7 @@ void proc_destroy(proc *obj)
 {
     char_buffer_destroy(obj->char_buffer);
     free(obj->cmd_buffer);
+    text_destroy(&obj->record);
     if (obj->err_publisher)
         err_publisher_destroy(obj->err_publisher);
     free(obj);
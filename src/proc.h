@@ -35,16 +35,76 @@
 #include "config.h"
 #include "logger.h"
 #include "stdbool.h"
+#include "utils.h"
 
 typedef struct proc_st proc;
 
-enum action { UNKNOWN, PULL, PUSH, CHECKOUT, CLONE, STATUS, LIST, EXEC, PATH };
+enum action {
+    UNKNOWN,
+    PULL,
+    PUSH,
+    CHECKOUT,
+    CLONE,
+    STATUS,
+    LIST,
+    EXEC,
+    PATH,
+    STATS,
+    PLAN,
+    SYNC
+};
 
 /*
- * Indicates if Git DCVS is installed on this system.
+ * The outcome of an action taken on a single project.
+ */
+struct proc_result {
+    enum action action;
+    const char *path;
+    const char *project;
+    const char *project_path;
+    /* Exit code of the command or -1 if it could not be run */
+    int exit_code;
+    /* 1 if the working tree has changes, 0 if clean or -1 if unknown */
+    int dirty;
+    /* Commits ahead of and behind the upstream or -1 if unknown */
+    int ahead;
+    int behind;
+    long long duration_ns;
+    /* Bytes of output read from the commands run */
+    long long bytes;
+    /*
+     * The current branch (or NULL if unknown), the head of the command
+     * output and the error the action failed with (or NULL if none). All
+     * are valid while the result is being handled.
+     */
+    const char *branch;
+    const char *output;
+    int output_len;
+    bool output_truncated;
+    const char *error;
+};
+
+/*
+ * Indicates if Git DCVS is installed on this system, that is an executable
+ * git is found on the PATH. The lookup is made once and only when first
+ * asked for.
  */
 bool proc_is_git_installed();
 
+/* Git arguments of the status probes, shared with the where command */
+#define PROC_CMD_STATUS "status --porcelain"
+#define PROC_CMD_AHEAD_BEHIND "rev-list --left-right --count HEAD...@{upstream}"
+
+/* Room for the path to Git followed by its arguments */
+#define PROC_GIT_CMD_LEN (2 * MAX_PATH + 4)
+
+/*
+ * Formats the Git command with the specified arguments into the destination
+ * of PROC_GIT_CMD_LEN characters and returns it. Git is run by its absolute
+ * path so that the shell does not have to search for it.
+ */
+const char *proc_git_command(char *, const char *);
+
 /*
  * Constructs this class.
  */
@@ -55,15 +115,28 @@ proc *proc_new(logger *, config *);
  */
 void proc_set_err_handler(proc *, void *, void (*)(void *, int, const char *));
 
+/*
+ * Sets the handler notified of the result of each action taken on a project.
+ */
+void proc_set_result_handler(
+        proc *, void *, void (*)(void *, const struct proc_result *));
+
+/*
+ * Enables counting the commits ahead of and behind the upstream branch after
+ * each action (at the cost of an extra Git command per project).
+ */
+void proc_set_upstream_tracking(proc *, bool);
+
 /*
  * Initialises this object off the specified command line.
  */
 bool proc_parse_cmd_line(proc *, int, char *[]);
 
 /*
- * Takes action at the specified location.
+ * Takes action on the project given the workspace path, the project name and
+ * the full path to the project.
  */
-void proc_action(proc *, const char *, const char *);
+void proc_action(proc *, const char *, const char *, const char *);
 
 /*
  * Takes a single non-repetitive action if one is assigned.
@@ -71,11 +144,42 @@ void proc_action(proc *, const char *, const char *);
 void proc_single_action(
         proc *, void *, int (*)(void *, const char *, char *, int));
 
+/*
+ * Indicates if the assigned action runs Git.
+ */
+bool proc_is_git_required(proc *);
+
 /*
  * Returns the currently assigned action.
  */
 enum action proc_get_action(proc *);
 
+/*
+ * Returns the command line name of the specified action.
+ */
+const char *proc_action_name(enum action);
+
+/*
+ * Looks up the action by its command line name. Returns UNKNOWN if the name
+ * is not recognised.
+ */
+enum action proc_parse_action_name(const char *);
+
+/*
+ * Returns the workspace alias the stats command is restricted to or NULL.
+ */
+const char *proc_get_workspace_filter(proc *);
+
+/*
+ * Returns the virtual path (<alias>/<project>) of the path command or NULL.
+ */
+const char *proc_get_virtual_path(proc *);
+
+/*
+ * Returns the action the stats command is restricted to or UNKNOWN.
+ */
+enum action proc_get_action_filter(proc *);
+
 /*
  * Indicates the if the assigned action is repetitive.
  */
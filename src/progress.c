@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * progress.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "progress.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include "containers.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+/* Ten frames per second are smooth enough for counting seconds */
+#define FRAME_NS 100000000LL
+#define DEFAULT_WIDTH 80
+#define LABEL_LEN 128
+#define LINE_LEN 512
+
+DECLARE_VECTOR(text, char)
+
+struct flight {
+    int job;
+    long long start_ns;
+    char label[LABEL_LEN];
+};
+
+struct progress_st {
+    int fd;
+    int jobs;
+    int concurrency;
+    /* Expected duration of every job or -1 if unknown */
+    long long *expected;
+    long long expected_ns;
+    int expected_count;
+    /* Expected durations of the jobs not started yet and the number of
+     * those without one */
+    long long pending_ns;
+    int pending_unknown;
+    struct flight *flights;
+    int flight_count;
+    int done;
+    long long done_ns;
+    long long start_ns;
+    long long next_frame_ns;
+    /* Lines of the display on the screen */
+    int lines;
+    struct text screen;
+};
+
+progress *progress_new(int fd, int jobs, int concurrency)
+{
+    progress *obj = malloc(sizeof(struct progress_st));
+    obj->fd = fd;
+    obj->jobs = jobs;
+    obj->concurrency = concurrency;
+    obj->expected = malloc((jobs ? jobs : 1) * sizeof(long long));
+    for (int i = 0; i < jobs; i++)
+        obj->expected[i] = -1;
+    obj->expected_ns = 0;
+    obj->expected_count = 0;
+    obj->pending_ns = 0;
+    obj->pending_unknown = jobs;
+    obj->flights = malloc(concurrency * sizeof(struct flight));
+    obj->flight_count = 0;
+    obj->done = 0;
+    obj->done_ns = 0;
+    obj->start_ns = -1;
+    obj->next_frame_ns = 0;
+    obj->lines = 0;
+    text_init(&obj->screen);
+    return obj;
+}
+
+void progress_expect(progress *obj, int job, long long ns)
+{
+    if (ns < 0 || obj->expected[job] >= 0)
+        return;
+    obj->expected[job] = ns;
+    obj->expected_ns += ns;
+    obj->expected_count++;
+    obj->pending_ns += ns;
+    obj->pending_unknown--;
+}
+
+void progress_start(progress *obj, int job, const char *label, long long now)
+{
+    if (obj->flight_count == obj->concurrency)
+        return;
+    if (obj->start_ns < 0)
+        obj->start_ns = now;
+    if (obj->expected[job] >= 0)
+        obj->pending_ns -= obj->expected[job];
+    else
+        obj->pending_unknown--;
+    struct flight *f = &obj->flights[obj->flight_count++];
+    f->job = job;
+    f->start_ns = now;
+    snprintf(f->label, LABEL_LEN, "%s", label);
+}
+
+void progress_finish(progress *obj, int job, long long now)
+{
+    for (int i = 0; i < obj->flight_count; i++) {
+        if (obj->flights[i].job == job) {
+            obj->done++;
+            obj->done_ns += now - obj->flights[i].start_ns;
+            /* Keep the remaining jobs in the order they started */
+            memmove(&obj->flights[i], &obj->flights[i + 1],
+                    (obj->flight_count - i - 1) * sizeof(struct flight));
+            obj->flight_count--;
+            return;
+        }
+    }
+}
+
+/*
+ * Writes out the screen update at once.
+ */
+static void flush_screen(progress *obj)
+{
+    write_fully(obj->fd, obj->screen.items, obj->screen.size);
+    text_clear(&obj->screen);
+}
+
+/*
+ * Moves the cursor to the first line of the display and clears the screen
+ * from there.
+ */
+static void erase(progress *obj)
+{
+    if (!obj->lines)
+        return;
+    char seq[32];
+    text_append(&obj->screen, seq,
+            snprintf(seq, sizeof(seq), "\033[%dF\033[J", obj->lines));
+    obj->lines = 0;
+}
+
+static int terminal_width(progress *obj)
+{
+    struct winsize size;
+    if (ioctl(obj->fd, TIOCGWINSZ, &size) || !size.ws_col)
+        return DEFAULT_WIDTH;
+    return size.ws_col < LINE_LEN ? size.ws_col : LINE_LEN;
+}
+
+/*
+ * Appends the line cut to fit the terminal, since a wrapped line would
+ * throw the erasing off.
+ */
+static void append_line(progress *obj, const char *line, int width)
+{
+    int len = strlen(line);
+    if (len >= width) {
+        len = width - 1;
+        /* Do not split a multibyte character */
+        while (len > 0 && ((unsigned char)line[len] & 0xc0) == 0x80)
+            len--;
+    }
+    text_append(&obj->screen, line, len);
+    text_append(&obj->screen, "\n", 1);
+    obj->lines++;
+}
+
+static void format_duration(char *dst, int len, long long ns)
+{
+    long long s = ns / 1000000000LL;
+    if (s >= 3600)
+        snprintf(dst, len, "%lldh%02lldm", s / 3600, s / 60 % 60);
+    else if (s >= 60)
+        snprintf(dst, len, "%lldm%02llds", s / 60, s % 60);
+    else
+        snprintf(dst, len, "%.1fs", ns / 1e9);
+}
+
+/*
+ * Estimates the time left till all the jobs are done. Returns false if
+ * there is nothing to go by yet.
+ */
+static bool estimate_left(progress *obj, long long now, long long *left)
+{
+    long long average = -1;
+    if (obj->done)
+        average = obj->done_ns / obj->done;
+    else if (obj->expected_count)
+        average = obj->expected_ns / obj->expected_count;
+    if (average < 0)
+        return false;
+
+    long long work = obj->pending_ns + obj->pending_unknown * average;
+    for (int i = 0; i < obj->flight_count; i++) {
+        const struct flight *f = &obj->flights[i];
+        long long expected = obj->expected[f->job] >= 0
+                                     ? obj->expected[f->job]
+                                     : average;
+        if (expected > now - f->start_ns)
+            work += expected - (now - f->start_ns);
+    }
+    int running = obj->jobs - obj->done;
+    if (running > obj->concurrency)
+        running = obj->concurrency;
+    *left = running ? work / running : 0;
+    return true;
+}
+
+static void draw(progress *obj, long long now)
+{
+    int width = terminal_width(obj);
+    char line[LINE_LEN];
+    char duration[32];
+    for (int i = 0; i < obj->flight_count; i++) {
+        const struct flight *f = &obj->flights[i];
+        format_duration(duration, sizeof(duration), now - f->start_ns);
+        snprintf(line, LINE_LEN, "  %8s  %s", duration, f->label);
+        append_line(obj, line, width);
+    }
+
+    int len = snprintf(line, LINE_LEN, "[%d/%d]", obj->done, obj->jobs);
+    if (obj->done && now > obj->start_ns) {
+        len += snprintf(line + len, LINE_LEN - len, " %.1f jobs/s",
+                obj->done * 1e9 / (now - obj->start_ns));
+    }
+    long long left;
+    if (estimate_left(obj, now, &left)) {
+        format_duration(duration, sizeof(duration), left);
+        snprintf(line + len, LINE_LEN - len, " ETA %s", duration);
+    }
+    append_line(obj, line, width);
+}
+
+void progress_write(progress *obj, const char *text, int len)
+{
+    erase(obj);
+    text_append(&obj->screen, text, len);
+    flush_screen(obj);
+}
+
+int progress_refresh(progress *obj, long long now)
+{
+    if (now >= obj->next_frame_ns) {
+        erase(obj);
+        draw(obj, now);
+        flush_screen(obj);
+        obj->next_frame_ns = now + FRAME_NS;
+    }
+    return (int)((obj->next_frame_ns - now + 999999) / 1000000);
+}
+
+void progress_destroy(progress *obj)
+{
+    erase(obj);
+    flush_screen(obj);
+    text_destroy(&obj->screen);
+    free(obj->expected);
+    free(obj->flights);
+    free(obj);
+}
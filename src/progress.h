@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * progress.h
+ *
+ * Live progress display of concurrent jobs on a terminal. Every job in
+ * flight gets a line with its elapsed time, followed by a summary of the
+ * completed jobs, the throughput and the estimated time left. The display
+ * is redrawn at a fixed frame rate whatever the rate of the updates.
+ */
+
+#ifndef PROGRESS_H_
+#define PROGRESS_H_
+
+typedef struct progress_st progress;
+
+/*
+ * Constructs the display of the specified number of jobs run with the given
+ * concurrency on the terminal with the specified file descriptor.
+ */
+progress *progress_new(int, int, int);
+
+/*
+ * Sets the expected duration of the job in nanoseconds, e.g. off the past
+ * runs. The estimate of a job without one is the average of those done.
+ */
+void progress_expect(progress *, int, long long);
+
+/*
+ * Marks the job as started at the specified time with the given label.
+ */
+void progress_start(progress *, int, const char *, long long);
+
+/*
+ * Marks the job as done at the specified time.
+ */
+void progress_finish(progress *, int, long long);
+
+/*
+ * Writes the specified text, which has to end with a line break, above the
+ * display.
+ */
+void progress_write(progress *, const char *, int);
+
+/*
+ * Redraws the display if the next frame is due at the specified time.
+ * Returns the milliseconds left till the next frame.
+ */
+int progress_refresh(progress *, long long);
+
+/*
+ * Erases the display and destroys it.
+ */
+void progress_destroy(progress *);
+
+#endif /* PROGRESS_H_ */
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * stats.c
+ */
+
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "hashmap.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+#define KEY_LEN 600
+#define INITIAL_RUNS 16
+/* The fewest runs to tell a trend from */
+#define TREND_MIN_RUNS 4
+
+/*
+ * The durations of the runs of an action on a project in the order they
+ * were recorded in.
+ */
+struct series {
+    char *workspace;
+    char *project;
+    enum action action;
+    long long *durations;
+    int count;
+    int capacity;
+    int failures;
+    long long bytes;
+};
+
+DECLARE_VECTOR(series_vector, struct series *)
+
+struct stats_st {
+    universe *universe;
+    const char *workspace;
+    enum action action;
+    HHASHMAP series_by_key;
+    struct series_vector series;
+};
+
+stats *stats_new(universe *universe, const char *workspace, enum action action)
+{
+    stats *obj = malloc(sizeof(struct stats_st));
+    obj->universe = universe;
+    obj->workspace = workspace;
+    obj->action = action;
+    obj->series_by_key = hash_map_create();
+    series_vector_init(&obj->series);
+    return obj;
+}
+
+static struct series *get_series(stats *obj, const struct history_entry *e)
+{
+    char key[KEY_LEN];
+    snprintf(key, KEY_LEN, "%s/%s/%d", e->workspace, e->project, e->action);
+    struct series *s = hash_map_get(obj->series_by_key, key);
+    if (!s) {
+        s = malloc(sizeof(struct series));
+        s->workspace = strdup(e->workspace);
+        s->project = strdup(e->project);
+        s->action = e->action;
+        s->capacity = INITIAL_RUNS;
+        s->durations = malloc(s->capacity * sizeof(long long));
+        s->count = s->failures = 0;
+        s->bytes = 0;
+        hash_map_put(obj->series_by_key, key, s);
+        series_vector_push(&obj->series, s);
+    }
+    return s;
+}
+
+void stats_add(stats *obj, const struct history_entry *e)
+{
+    if (obj->workspace && strcmp(obj->workspace, e->workspace))
+        return;
+    if (obj->action != UNKNOWN && obj->action != e->action)
+        return;
+    /* Skip the workspaces that are no longer defined */
+    if (!universe_get_workspace_path(obj->universe, e->workspace))
+        return;
+
+    struct series *s = get_series(obj, e);
+    if (s->count == s->capacity) {
+        s->capacity *= 2;
+        s->durations = realloc(s->durations, s->capacity * sizeof(long long));
+    }
+    s->durations[s->count++] = e->duration_ns;
+    s->failures += e->exit_code != 0;
+    s->bytes += e->bytes;
+}
+
+static void add_entry(void *inst, const struct history_entry *e)
+{
+    stats_add(inst, e);
+}
+
+bool stats_load(stats *obj, const char *file_name)
+{
+    return history_read(file_name, obj, add_entry);
+}
+
+static int compare_durations(const void *a, const void *b)
+{
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Returns the nearest-rank percentile of the sorted durations.
+ */
+static long long percentile(const long long *sorted, int count, int p)
+{
+    int rank = (p * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/*
+ * Returns the median of the specified durations (which get sorted).
+ */
+static long long median(long long *durations, int count)
+{
+    qsort(durations, count, sizeof(long long), compare_durations);
+    return percentile(durations, count, 50);
+}
+
+static void summarise(struct series *s, struct stats_summary *dst)
+{
+    dst->runs = s->count;
+    dst->failures = s->failures;
+    dst->bytes = s->bytes / s->count;
+
+    long long *sorted = malloc(s->count * sizeof(long long));
+    memcpy(sorted, s->durations, s->count * sizeof(long long));
+    qsort(sorted, s->count, sizeof(long long), compare_durations);
+    dst->p50_ns = percentile(sorted, s->count, 50);
+    dst->p95_ns = percentile(sorted, s->count, 95);
+    dst->p99_ns = percentile(sorted, s->count, 99);
+
+    /* Compare the medians of the earlier and the later runs */
+    dst->has_trend = false;
+    dst->trend = 0;
+    if (s->count >= TREND_MIN_RUNS) {
+        int half = s->count / 2;
+        memcpy(sorted, s->durations, s->count * sizeof(long long));
+        long long earlier = median(sorted, half);
+        long long later = median(sorted + s->count - half, half);
+        if (earlier > 0) {
+            dst->trend = (double)later / earlier - 1;
+            dst->has_trend = true;
+        }
+    }
+    free(sorted);
+}
+
+bool stats_get(stats *obj, const char *workspace, const char *project,
+        enum action action, struct stats_summary *dst)
+{
+    char key[KEY_LEN];
+    snprintf(key, KEY_LEN, "%s/%s/%d", workspace, project, action);
+    struct series *s = hash_map_get(obj->series_by_key, key);
+    if (!s)
+        return false;
+    summarise(s, dst);
+    return true;
+}
+
+static int compare_series(const void *a, const void *b)
+{
+    const struct series *x = *(struct series *const *)a;
+    const struct series *y = *(struct series *const *)b;
+    int result = strcmp(x->workspace, y->workspace);
+    if (!result)
+        result = strcmp(x->project, y->project);
+    return result ? result : (int)x->action - (int)y->action;
+}
+
+static void print_series(struct series *s)
+{
+    struct stats_summary summary;
+    summarise(s, &summary);
+    printf("  %-24s %-9s %6d %6.1f%% %8.3fs %8.3fs %8.3fs %10lld ", s->project,
+            proc_action_name(s->action), summary.runs,
+            100.0 * summary.failures / summary.runs, summary.p50_ns / 1e9,
+            summary.p95_ns / 1e9, summary.p99_ns / 1e9, summary.bytes);
+    if (summary.has_trend)
+        printf("%+6.0f%%\n", 100 * summary.trend);
+    else
+        printf("%7s\n", "-");
+}
+
+void stats_print(stats *obj)
+{
+    struct series_vector sorted;
+    series_vector_clone(&sorted, &obj->series);
+    qsort(sorted.items, sorted.size, sizeof(struct series *), compare_series);
+
+    const char *last_workspace = NULL;
+    VECTOR_FOREACH(struct series *, it, &sorted) {
+        struct series *s = *it;
+        if (!last_workspace || strcmp(last_workspace, s->workspace)) {
+            printf("Workspace %s (name: %s)\n",
+                    universe_get_workspace_path(obj->universe, s->workspace),
+                    s->workspace);
+            printf("  %-24s %-9s %6s %7s %9s %9s %9s %10s %7s\n", "Project",
+                    "Action", "Runs", "Failed", "p50", "p95", "p99",
+                    "Bytes/run", "Trend");
+            last_workspace = s->workspace;
+        }
+        print_series(s);
+    }
+    if (!sorted.size)
+        puts("No history recorded");
+    series_vector_destroy(&sorted);
+}
+
+void stats_destroy(stats *obj)
+{
+    VECTOR_FOREACH(struct series *, it, &obj->series) {
+        struct series *s = *it;
+        free(s->workspace);
+        free(s->project);
+        free(s->durations);
+        free(s);
+    }
+    series_vector_destroy(&obj->series);
+    hash_map_destroy(obj->series_by_key);
+    free(obj);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Duration percentiles, failure rates and trends per project computed off
+ * the run history.
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdbool.h>
+#include "history.h"
+#include "proc.h"
+#include "universe.h"
+
+typedef struct stats_st stats;
+
+/*
+ * The statistics of an action taken on a project.
+ */
+struct stats_summary {
+    int runs;
+    int failures;
+    long long p50_ns;
+    long long p95_ns;
+    long long p99_ns;
+    /* Average bytes of output per run */
+    long long bytes;
+    /*
+     * Relative change of the median duration of the later half of the runs
+     * against the earlier half, valid if has_trend is set
+     */
+    double trend;
+    bool has_trend;
+};
+
+/*
+ * Creates the statistics of the projects of the workspaces defined in the
+ * universe, optionally restricted to a workspace alias (unless NULL) and
+ * an action (unless UNKNOWN).
+ */
+stats *stats_new(universe *, const char *, enum action);
+
+/*
+ * Accounts for the specified history entry unless filtered out.
+ */
+void stats_add(stats *, const struct history_entry *);
+
+/*
+ * Accounts for all the entries of the specified history file. Returns false
+ * if the file cannot be read.
+ */
+bool stats_load(stats *, const char *);
+
+/*
+ * Summarises the runs of an action on a project of the named workspace.
+ * Returns false if there are none.
+ */
+bool stats_get(stats *, const char *, const char *, enum action,
+        struct stats_summary *);
+
+/*
+ * Prints out the statistics grouped by workspace.
+ */
+void stats_print(stats *);
+
+/*
+ * Destroys the specified statistics.
+ */
+void stats_destroy(stats *);
+
+#endif /* STATS_H_ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * strpool.c
+ */
+#include "strpool.h"
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "alloctrace.h"
+
+/* The size of the regular blocks the strings are carved out of */
+#define BLOCK_SIZE 4096
+
+/*
+ * A chunk of the arena. The strings longer than a regular block get a block
+ * of their own.
+ */
+struct block {
+    struct block *next;
+    size_t size;
+    size_t used;
+    char data[];
+};
+
+/* Lengths of the interned strings keyed by the strings */
+DECLARE_STR_MAP(intern_map, size_t)
+
+struct str_pool_st {
+    /* The block being filled, followed by the full ones */
+    struct block *blocks;
+    struct intern_map index;
+};
+
+str_pool *str_pool_new()
+{
+    str_pool *obj = malloc(sizeof(struct str_pool_st));
+    obj->blocks = NULL;
+    intern_map_init(&obj->index);
+    return obj;
+}
+
+/*
+ * Reserves the specified number of characters at the top of the arena
+ * without committing them.
+ */
+static char *reserve(str_pool *obj, size_t size)
+{
+    struct block *b = obj->blocks;
+    if (b && b->size - b->used >= size)
+        return b->data + b->used;
+    size_t block_size = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+    b = malloc(sizeof(struct block) + block_size);
+    if (!b)
+        return NULL;
+    b->size = block_size;
+    b->used = 0;
+    if (size > BLOCK_SIZE && obj->blocks) {
+        /* Keep filling the current block */
+        b->next = obj->blocks->next;
+        obj->blocks->next = b;
+    } else {
+        b->next = obj->blocks;
+        obj->blocks = b;
+    }
+    return b->data;
+}
+
+const char *str_pool_intern_n(str_pool *obj, const char *s, size_t len)
+{
+    /*
+     * Copy the string to the top of the arena first so that it can be
+     * looked up zero-terminated, and only commit the copy if it is new.
+     */
+    char *copy = reserve(obj, len + 1);
+    if (!copy)
+        return NULL;
+    memcpy(copy, s, len);
+    copy[len] = 0;
+    unsigned hash = str_hash(copy);
+    if (intern_map_size(&obj->index)) {
+        struct intern_map_slot *slot =
+                intern_map_probe(&obj->index, copy, hash);
+        if (slot->key)
+            return slot->key;
+    }
+    if (!intern_map_put(&obj->index, copy, len))
+        return NULL;
+    struct block *b = obj->blocks;
+    if (copy < b->data || copy >= b->data + b->size)
+        b = b->next; /* a block of its own */
+    b->used += len + 1;
+    return copy;
+}
+
+const char *str_pool_intern(str_pool *obj, const char *s)
+{
+    return str_pool_intern_n(obj, s, strlen(s));
+}
+
+int str_pool_get_size(str_pool *obj)
+{
+    return intern_map_size(&obj->index);
+}
+
+void str_pool_destroy(str_pool *obj)
+{
+    struct block *b = obj->blocks;
+    while (b) {
+        struct block *next = b->next;
+        free(b);
+        b = next;
+    }
+    intern_map_destroy(&obj->index);
+    free(obj);
+}
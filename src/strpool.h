@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * strpool.h
+ *
+ * Arena of interned strings. Every distinct string is stored once, so the
+ * interned strings can be compared by pointer, and they are all freed at
+ * once when the pool is destroyed.
+ */
+
+#ifndef STRPOOL_H_
+#define STRPOOL_H_
+
+#include <stddef.h>
+
+typedef struct str_pool_st str_pool;
+
+str_pool *str_pool_new();
+
+/*
+ * Returns the pooled copy of the specified string, adding it to the pool if
+ * it is not there yet. The copy lives as long as the pool. Returns NULL if
+ * out of memory.
+ */
+const char *str_pool_intern(str_pool *, const char *);
+
+/*
+ * Same as str_pool_intern() but takes the first specified number of
+ * characters, which need not be zero-terminated.
+ */
+const char *str_pool_intern_n(str_pool *, const char *, size_t);
+
+/*
+ * Returns the number of distinct strings in the pool.
+ */
+int str_pool_get_size(str_pool *);
+
+/*
+ * Frees all the pooled strings along with the pool.
+ */
+void str_pool_destroy(str_pool *);
+
+#endif /* STRPOOL_H_ */
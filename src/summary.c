@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * summary.c
+ */
+
+#include "summary.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "alloctrace.h"
+
+/* The longest error line kept */
+#define ERROR_LINE_LEN 128
+
+struct failure {
+    const char *workspace;
+    const char *project;
+    int exit_code;
+    char error[ERROR_LINE_LEN];
+};
+
+DECLARE_VECTOR(failure_vector, struct failure)
+
+struct summary_st {
+    int projects;
+    struct failure_vector failures;
+};
+
+summary *summary_new()
+{
+    summary *obj = malloc(sizeof(struct summary_st));
+    obj->projects = 0;
+    failure_vector_init(&obj->failures);
+    return obj;
+}
+
+/* Copies the line starting at the specified position to the destination */
+static void copy_line(char *dst, const char *s, const char *end)
+{
+    int len = 0;
+    while (s + len < end && s[len] != '\n' && s[len] != '\r' &&
+            len < ERROR_LINE_LEN - 1)
+        len++;
+    memcpy(dst, s, len);
+    dst[len] = 0;
+}
+
+/*
+ * Finds the first line of the output Git reported an error on. The error
+ * of the action or the first line of the output stand in for it otherwise.
+ */
+static void find_error_line(char *dst, const struct proc_result *result)
+{
+    const char *output = result->output ? result->output : "";
+    const char *end = output + result->output_len;
+    const char *first = NULL;
+    for (const char *s = output; s < end;) {
+        if (end - s >= 6 &&
+                (!strncmp(s, "fatal:", 6) || !strncmp(s, "error:", 6))) {
+            copy_line(dst, s, end);
+            return;
+        }
+        const char *eol = memchr(s, '\n', end - s);
+        if (!first && s != (eol ? eol : end))
+            first = s;
+        s = eol ? eol + 1 : end;
+    }
+    if (result->error)
+        copy_line(dst, result->error, result->error + strlen(result->error));
+    else if (first)
+        copy_line(dst, first, end);
+    else
+        *dst = 0;
+}
+
+void summary_add(
+        summary *obj, const char *workspace, const struct proc_result *result)
+{
+    obj->projects++;
+    if (!result->exit_code && !result->error)
+        return;
+    struct failure failure;
+    failure.workspace = workspace;
+    failure.project = result->project;
+    failure.exit_code = result->exit_code;
+    find_error_line(failure.error, result);
+    failure_vector_push(&obj->failures, failure);
+}
+
+int summary_get_failures(summary *obj)
+{
+    return obj->failures.size;
+}
+
+void summary_print(summary *obj, FILE *file)
+{
+    if (!obj->failures.size)
+        return;
+    int workspace_len = strlen("WORKSPACE");
+    int project_len = strlen("PROJECT");
+    VECTOR_FOREACH(struct failure, f, &obj->failures) {
+        int len = strlen(f->workspace);
+        if (len > workspace_len)
+            workspace_len = len;
+        len = strlen(f->project);
+        if (len > project_len)
+            project_len = len;
+    }
+    fprintf(file, "Failed on %d of %d projects:\n", obj->failures.size,
+            obj->projects);
+    fprintf(file, "%-*s  %-*s  %4s  %s\n", workspace_len, "WORKSPACE",
+            project_len, "PROJECT", "EXIT", "ERROR");
+    VECTOR_FOREACH(struct failure, f, &obj->failures) {
+        fprintf(file, "%-*s  %-*s  %4d  %s\n", workspace_len, f->workspace,
+                project_len, f->project, f->exit_code, f->error);
+    }
+}
+
+void summary_destroy(summary *obj)
+{
+    failure_vector_destroy(&obj->failures);
+    free(obj);
+}
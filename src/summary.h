@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Summary of the projects an action failed on.
+ */
+
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+#include <stdio.h>
+#include "proc.h"
+
+typedef struct summary_st summary;
+
+/*
+ * Creates a new failure summary.
+ */
+summary *summary_new();
+
+/*
+ * Records the result of an action taken on a project of the named workspace,
+ * keeping the first error line of it if the action failed. The workspace and
+ * project names must outlive this summary.
+ */
+void summary_add(summary *, const char *, const struct proc_result *);
+
+/*
+ * Returns the number of projects the action failed on.
+ */
+int summary_get_failures(summary *);
+
+/*
+ * Prints out the table of the failed projects with their exit codes and
+ * first error lines.
+ */
+void summary_print(summary *, FILE *);
+
+/*
+ * Destroys the specified summary.
+ */
+void summary_destroy(summary *);
+
+#endif /* SUMMARY_H_ */
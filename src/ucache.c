@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ucache.c
+ *
+ * The image starts with a fixed size header followed by the workspace table,
+ * the project table, the alias hash index and the string table, in that
+ * order. The tables refer to each other by index and to the strings by their
+ * offsets in the string table, so the image can be used wherever it is
+ * mapped. The strings are zero-terminated and stored once each.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ucache.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "containers.h"
+#include "utils.h"
+#include "alloctrace.h"
+
+#define MAGIC "OCTOUC01"
+#define MAGIC_LEN 8
+
+/*
+ * The header of the image. The offsets of the tables are relative to the
+ * start of the image. The fields are ordered so that there is no padding
+ * between them.
+ */
+struct image_header {
+    char magic[MAGIC_LEN];
+    uint64_t file_size;
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    uint64_t source_hash;
+    /* The definition file name, an offset in the string table */
+    uint32_t source_name;
+    uint32_t workspace_count;
+    uint32_t workspaces;
+    uint32_t project_count;
+    uint32_t projects;
+    /* The number of slots in the alias index, a power of two */
+    uint32_t index_capacity;
+    uint32_t index;
+    uint32_t strings;
+    uint32_t strings_size;
+    uint32_t reserved;
+};
+
+struct image_workspace {
+    uint32_t name;
+    uint32_t path;
+    /* The projects of the workspace are adjacent in the project table */
+    uint32_t first_project;
+    uint32_t project_count;
+};
+
+struct ucache_st {
+    const char *image;
+    size_t size;
+    const struct image_header *header;
+    const struct image_workspace *workspaces;
+    /* String table offsets of the projects */
+    const uint32_t *projects;
+    /* Workspace indices plus one, or zeros for empty slots */
+    const uint32_t *index;
+    const char *strings;
+};
+
+uint64_t ucache_hash(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+char *ucache_file_name(const char *def_file_name)
+{
+    size_t len = strlen(def_file_name);
+    char *name = malloc(len + sizeof(".cache"));
+    memcpy(name, def_file_name, len);
+    memcpy(name + len, ".cache", sizeof(".cache"));
+    return name;
+}
+
+int64_t ucache_mtime_ns(const struct stat *st)
+{
+#ifdef __APPLE__
+    return (int64_t)st->st_mtimespec.tv_sec * 1000000000 +
+            st->st_mtimespec.tv_nsec;
+#else
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+/* Checks that the table of the specified size fits in the image */
+static bool fits(const struct image_header *h, uint64_t offset, uint64_t count,
+        uint64_t item_size)
+{
+    return offset >= sizeof(struct image_header) &&
+            offset % sizeof(uint32_t) == 0 &&
+            offset + count * item_size <= h->file_size;
+}
+
+/*
+ * Checks that every reference in the image points inside it so that a
+ * corrupt image cannot be read out of bounds.
+ */
+static bool is_valid(ucache *obj)
+{
+    const struct image_header *h = obj->header;
+    if (obj->size < sizeof(struct image_header) ||
+            memcmp(h->magic, MAGIC, MAGIC_LEN) || h->file_size != obj->size)
+        return false;
+    if (!fits(h, h->workspaces, h->workspace_count,
+                sizeof(struct image_workspace)) ||
+            !fits(h, h->projects, h->project_count, sizeof(uint32_t)) ||
+            !fits(h, h->index, h->index_capacity, sizeof(uint32_t)) ||
+            (h->index_capacity & (h->index_capacity - 1)) ||
+            h->index_capacity <= h->workspace_count ||
+            (uint64_t)h->strings + h->strings_size != h->file_size ||
+            !h->strings_size || obj->image[h->file_size - 1])
+        return false;
+    obj->workspaces =
+            (const struct image_workspace *)(obj->image + h->workspaces);
+    obj->projects = (const uint32_t *)(obj->image + h->projects);
+    obj->index = (const uint32_t *)(obj->image + h->index);
+    obj->strings = obj->image + h->strings;
+    if (h->source_name >= h->strings_size)
+        return false;
+    for (uint32_t i = 0; i < h->workspace_count; i++) {
+        const struct image_workspace *w = &obj->workspaces[i];
+        if (w->name >= h->strings_size || w->path >= h->strings_size ||
+                (uint64_t)w->first_project + w->project_count >
+                        h->project_count)
+            return false;
+    }
+    for (uint32_t i = 0; i < h->project_count; i++) {
+        if (obj->projects[i] >= h->strings_size)
+            return false;
+    }
+    /* The lookups stop at the empty slots, so there has to be one */
+    bool empty = false;
+    for (uint32_t i = 0; i < h->index_capacity; i++) {
+        if (obj->index[i] > h->workspace_count)
+            return false;
+        empty |= !obj->index[i];
+    }
+    return empty;
+}
+
+/*
+ * Checks that the definition file has not changed since the image was
+ * written. A file touched without being changed is recognised by its hash
+ * and its new modification time is recorded in the image.
+ */
+static bool is_fresh(ucache *obj, const char *def_file_name,
+        const char *file_name)
+{
+    const struct image_header *h = obj->header;
+    if (strcmp(obj->strings + h->source_name, def_file_name))
+        return false;
+    int fd = open(def_file_name, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    bool fresh = !fstat(fd, &st) && S_ISREG(st.st_mode) &&
+            (uint64_t)st.st_size == h->source_size;
+    if (fresh && ucache_mtime_ns(&st) != h->source_mtime_ns) {
+        void *map = st.st_size ? mmap(NULL, st.st_size, PROT_READ,
+                                         MAP_PRIVATE, fd, 0)
+                               : NULL;
+        fresh = map != MAP_FAILED &&
+                ucache_hash(map, st.st_size) == h->source_hash;
+        if (map && map != MAP_FAILED)
+            munmap(map, st.st_size);
+        int64_t mtime = ucache_mtime_ns(&st);
+        int out = fresh ? open(file_name, O_WRONLY) : -1;
+        if (out >= 0) {
+            pwrite(out, &mtime, sizeof(mtime),
+                    offsetof(struct image_header, source_mtime_ns));
+            close(out);
+        }
+    }
+    close(fd);
+    return fresh;
+}
+
+ucache *ucache_open(const char *def_file_name)
+{
+    char *file_name = ucache_file_name(def_file_name);
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        free(file_name);
+        return NULL;
+    }
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) &&
+            st.st_size >= (off_t)sizeof(struct image_header))
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        free(file_name);
+        return NULL;
+    }
+    ucache *obj = malloc(sizeof(struct ucache_st));
+    obj->image = map;
+    obj->size = st.st_size;
+    obj->header = map;
+    if (!is_valid(obj) || !is_fresh(obj, def_file_name, file_name)) {
+        ucache_close(obj);
+        obj = NULL;
+    }
+    free(file_name);
+    return obj;
+}
+
+int ucache_get_workspace_count(ucache *obj)
+{
+    return obj->header->workspace_count;
+}
+
+const char *ucache_get_workspace_name(ucache *obj, int workspace)
+{
+    return obj->strings + obj->workspaces[workspace].name;
+}
+
+const char *ucache_get_workspace_path(ucache *obj, int workspace)
+{
+    return obj->strings + obj->workspaces[workspace].path;
+}
+
+int ucache_get_project_count(ucache *obj, int workspace)
+{
+    return obj->workspaces[workspace].project_count;
+}
+
+const char *ucache_get_project(ucache *obj, int workspace, int project)
+{
+    return obj->strings +
+            obj->projects[obj->workspaces[workspace].first_project + project];
+}
+
+int ucache_find_workspace(ucache *obj, const char *alias)
+{
+    uint32_t mask = obj->header->index_capacity - 1;
+    for (uint32_t i = str_hash(alias) & mask; obj->index[i];
+            i = (i + 1) & mask) {
+        int w = obj->index[i] - 1;
+        if (!strcmp(ucache_get_workspace_name(obj, w), alias))
+            return w;
+    }
+    return -1;
+}
+
+void ucache_close(ucache *obj)
+{
+    munmap((void *)obj->image, obj->size);
+    free(obj);
+}
+
+DECLARE_VECTOR(u32_vector, uint32_t)
+DECLARE_VECTOR(char_vector, char)
+DECLARE_STR_MAP(offset_map, uint32_t)
+
+/*
+ * The string table being assembled.
+ */
+struct string_table {
+    struct char_vector chars;
+    struct offset_map offsets;
+    bool failed;
+};
+
+/* Returns the offset of the string, adding it unless already there */
+static uint32_t add_string(struct string_table *t, const char *s)
+{
+    uint32_t *offset = offset_map_get(&t->offsets, s);
+    if (offset)
+        return *offset;
+    uint32_t result = t->chars.size;
+    int len = strlen(s) + 1;
+    if (!char_vector_append(&t->chars, s, len) ||
+            !offset_map_put(&t->offsets, s, result)) {
+        t->failed = true;
+        return 0;
+    }
+    return result;
+}
+
+bool ucache_write(const char *def_file_name, const struct ucache_source *source,
+        const struct ucache_workspace *workspaces, int count)
+{
+    struct image_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, MAGIC_LEN);
+    h.source_size = source->size;
+    h.source_mtime_ns = source->mtime_ns;
+    h.source_hash = source->hash;
+    h.workspace_count = count;
+
+    /* Assemble the tables */
+    struct string_table strings;
+    char_vector_init(&strings.chars);
+    offset_map_init(&strings.offsets);
+    strings.failed = false;
+    h.source_name = add_string(&strings, def_file_name);
+    struct image_workspace *image_workspaces =
+            calloc(count ? count : 1, sizeof(struct image_workspace));
+    struct u32_vector projects;
+    u32_vector_init(&projects);
+    h.index_capacity = CONTAINERS_MIN_CAPACITY;
+    while (h.index_capacity < 2 * (uint32_t)count)
+        h.index_capacity *= 2;
+    uint32_t *index = calloc(h.index_capacity, sizeof(uint32_t));
+    bool ok = image_workspaces && index;
+    for (int i = 0; i < count && ok; i++) {
+        struct image_workspace *w = &image_workspaces[i];
+        w->name = add_string(&strings, workspaces[i].name);
+        w->path = add_string(&strings, workspaces[i].path);
+        w->first_project = projects.size;
+        w->project_count = workspaces[i].project_count;
+        for (int j = 0; j < workspaces[i].project_count && ok; j++) {
+            ok = u32_vector_push(&projects,
+                    add_string(&strings, workspaces[i].projects[j]));
+        }
+        uint32_t mask = h.index_capacity - 1;
+        uint32_t slot = str_hash(workspaces[i].name) & mask;
+        while (index[slot])
+            slot = (slot + 1) & mask;
+        index[slot] = i + 1;
+    }
+    h.project_count = projects.size;
+    h.workspaces = sizeof(h);
+    h.projects = h.workspaces + count * sizeof(struct image_workspace);
+    h.index = h.projects + h.project_count * sizeof(uint32_t);
+    h.strings = h.index + h.index_capacity * sizeof(uint32_t);
+    h.strings_size = strings.chars.size;
+    h.file_size = (uint64_t)h.strings + h.strings_size;
+
+    /*
+     * Write a temporary file next to the image and rename it so that
+     * concurrent runs never see a partially written image.
+     */
+    char *file_name = ucache_file_name(def_file_name);
+    char tmp_name[MAX_PATH];
+    snprintf(tmp_name, sizeof(tmp_name), "%s.%ld.tmp", file_name,
+            (long)getpid());
+    ok = ok && !strings.failed;
+    FILE *file = ok ? fopen(tmp_name, "wb") : NULL;
+    ok = ok && file;
+    if (file) {
+        fwrite(&h, sizeof(h), 1, file);
+        fwrite(image_workspaces, sizeof(struct image_workspace), count, file);
+        fwrite(projects.items, sizeof(uint32_t), projects.size, file);
+        fwrite(index, sizeof(uint32_t), h.index_capacity, file);
+        fwrite(strings.chars.items, 1, strings.chars.size, file);
+        ok = !ferror(file) && ok;
+        ok = !fclose(file) && ok;
+        if (!ok || rename(tmp_name, file_name)) {
+            remove(tmp_name);
+            ok = false;
+        }
+    }
+    free(file_name);
+    free(index);
+    u32_vector_destroy(&projects);
+    free(image_workspaces);
+    offset_map_destroy(&strings.offsets);
+    char_vector_destroy(&strings.chars);
+    return ok;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ucache.h
+ *
+ * Binary image of a parsed universe kept next to its definition file. The
+ * image is position-independent, so later runs map it into memory and use
+ * it as is instead of parsing the definitions again.
+ */
+
+#ifndef UCACHE_H_
+#define UCACHE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ucache_st ucache;
+
+/*
+ * The state of the definition file the image was compiled from.
+ */
+struct ucache_source {
+    uint64_t size;
+    /* Modification time in nanoseconds since the epoch */
+    int64_t mtime_ns;
+    /* FNV-1a hash of the content */
+    uint64_t hash;
+};
+
+/*
+ * A workspace to write to the image.
+ */
+struct ucache_workspace {
+    const char *name;
+    const char *path;
+    const char *const *projects;
+    int project_count;
+};
+
+struct stat;
+
+/*
+ * Returns the 64-bit FNV-1a hash of the specified bytes.
+ */
+uint64_t ucache_hash(const void *, size_t);
+
+/*
+ * Returns the modification time in the specified file status in nanoseconds
+ * since the epoch.
+ */
+int64_t ucache_mtime_ns(const struct stat *);
+
+/*
+ * Returns the name of the image file of the specified definition file.
+ * The name has to be freed by the caller.
+ */
+char *ucache_file_name(const char *);
+
+/*
+ * Opens the image of the specified definition file. Returns NULL if there
+ * is none, or it is corrupt or stale, that is the definition file has
+ * changed since the image was written.
+ */
+ucache *ucache_open(const char *);
+
+/*
+ * Writes the image of the specified workspaces compiled from the definition
+ * file in the specified state. Returns false if the image cannot be written.
+ */
+bool ucache_write(const char *, const struct ucache_source *,
+        const struct ucache_workspace *, int);
+
+int ucache_get_workspace_count(ucache *);
+const char *ucache_get_workspace_name(ucache *, int);
+const char *ucache_get_workspace_path(ucache *, int);
+int ucache_get_project_count(ucache *, int);
+
+/*
+ * Returns the specified project of the specified workspace.
+ */
+const char *ucache_get_project(ucache *, int, int);
+
+/*
+ * Looks up the workspace by its alias. Returns -1 if there is none.
+ */
+int ucache_find_workspace(ucache *, const char *);
+
+/*
+ * Unmaps the image.
+ */
+void ucache_close(ucache *);
+
+#endif /* UCACHE_H_ */
@@ -28,199 +28,317 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+
+#define _POSIX_C_SOURCE 200809L
+
 #include "universe.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "containers.h"
 #include "dconsumer.h"
 #include "dparser.h"
 #include "errpublisher.h"
-#include "hashmap.h"
-#include "linkedlist.h"
 #include "logger.h"
+#include "strpool.h"
+#include "ucache.h"
 #include "utils.h"
 #include "workspace.h"
+#include "alloctrace.h"
+
+/* The size of the chunks the definition file is read in */
+#define PARSE_CHUNK_SIZE 65536
+
+DECLARE_VECTOR(workspace_vector, workspace *)
+DECLARE_VECTOR(string_vector, const char *)
+DECLARE_STR_MAP(workspace_map, workspace *)
 
 struct universe_st {
     logger *logger;
-    HLINKEDLIST workspaces;
+    struct workspace_vector workspaces;
     struct dconsumer *dconsumer;
     dparser *parser;
-    HLINKEDLIST default_projects;
-    HHASHMAP workspace_by_alias;
-    HLINKEDLIST alloc_strings;
-    void (*visit)(void *, const char *, const char *, const char *);
-    void *inst;
+    /* All the names and paths, interned */
+    str_pool *strings;
+    struct string_vector default_projects;
+    struct workspace_map workspace_by_alias;
     err_publisher *err_publisher;
+    /* The image the universe is read from instead of the definitions */
+    ucache *cache;
+    /* Whether the definitions are to be compiled into an image */
+    bool caching;
+    /* The only workspace materialised (interned) or NULL for all */
+    const char *workspace_filter;
+    /* Whether to stop parsing once the filtered workspace is declared */
+    bool path_only;
+    /* The state of the definition file parsed, if it can be cached */
+    bool source_known;
+    struct ucache_source source;
+    const char *err_msg;
 };
 
 static void parse_file(universe *, const char *);
 static void init_dconsumer(universe *, struct dconsumer *);
 
-universe *universe_new(logger *logger, const char *file_name,
-        void *err_handler_inst, void (*handle_err)(void *, int, const char *))
+/*
+ * Writes the image of the parsed universe next to the definition file.
+ */
+static void write_cache(universe *obj, const char *file_name)
+{
+    struct ucache_workspace *image_workspaces =
+            malloc((obj->workspaces.size + 1) * sizeof(*image_workspaces));
+    for (int i = 0; i < obj->workspaces.size; i++) {
+        workspace *w = obj->workspaces.items[i];
+        image_workspaces[i].name = workspace_get_name(w);
+        image_workspaces[i].path = workpace_get_path(w);
+        image_workspaces[i].projects = workspace_get_projects(w);
+        image_workspaces[i].project_count = workspace_get_project_count(w);
+    }
+    if (!ucache_write(file_name, &obj->source, image_workspaces,
+                obj->workspaces.size)) {
+        DEBUG_LOG(obj->logger, "Cannot write the cache of %s\n", file_name);
+    }
+    free(image_workspaces);
+}
+
+universe *universe_new_ex(logger *logger, const char *file_name,
+        const struct universe_options *options, void *err_handler_inst,
+        void (*handle_err)(void *, int, const char *))
 {
     if (!logger)
         return NULL;
     universe *obj = malloc(sizeof(struct universe_st));
     struct dconsumer *dconsumer = malloc(sizeof(struct dconsumer));
     obj->logger = logger;
-    obj->workspaces = linked_list_create();
+    workspace_vector_init(&obj->workspaces);
     init_dconsumer(obj, dconsumer);
     obj->dconsumer = dconsumer;
     obj->parser = dpaser_new(logger, dconsumer);
-    obj->default_projects = linked_list_create();
-    obj->workspace_by_alias = hash_map_create();
-    obj->alloc_strings = linked_list_create();
+    obj->strings = str_pool_new();
+    string_vector_init(&obj->default_projects);
+    workspace_map_init(&obj->workspace_by_alias);
     obj->err_publisher = err_publisher_new(err_handler_inst, handle_err);
-    parse_file(obj, file_name);
+    obj->workspace_filter = options->workspace
+            ? str_pool_intern(obj->strings, options->workspace)
+            : NULL;
+    obj->path_only = options->path_only && obj->workspace_filter;
+    /*
+     * Only a complete universe is worth caching. Should the image be out of
+     * date when a single workspace is wanted, parse just that workspace and
+     * leave the image to the next complete run.
+     */
+    obj->caching = options->cache && !obj->workspace_filter;
+    obj->source_known = false;
+    obj->err_msg = NULL;
+    obj->cache = options->cache && !options->rebuild_cache
+            ? ucache_open(file_name)
+            : NULL;
+    if (!obj->cache) {
+        dparser_set_workspace_filter(obj->parser, obj->workspace_filter);
+        parse_file(obj, file_name);
+        if (obj->caching && obj->source_known && !obj->err_msg)
+            write_cache(obj, file_name);
+    }
     return obj;
 }
 
-static void visit_workspace(void *inst, void *workspace)
+universe *universe_new(logger *logger, const char *file_name,
+        void *err_handler_inst, void (*handle_err)(void *, int, const char *))
 {
-    universe *obj = inst;
-    workspace_accept(workspace, obj->inst, obj->visit);
+    struct universe_options options = {false, false, NULL, false};
+    return universe_new_ex(
+            logger, file_name, &options, err_handler_inst, handle_err);
 }
 
 void universe_accept(universe *obj, void *inst,
         void (*visit)(void *, const char *, const char *, const char *))
 {
-    obj->visit = visit;
-    obj->inst = inst;
-    linked_list_traverse(obj->workspaces, obj, visit_workspace);
+    if (obj->cache) {
+        ucache *c = obj->cache;
+        int w = 0, count = ucache_get_workspace_count(c);
+        if (obj->workspace_filter) {
+            /* Visit the only workspace found through the alias index */
+            w = ucache_find_workspace(c, obj->workspace_filter);
+            if (w < 0)
+                return;
+            count = w + 1;
+        }
+        for (; w < count; w++) {
+            const char *name = ucache_get_workspace_name(c, w);
+            const char *path = ucache_get_workspace_path(c, w);
+            for (int p = 0; p < ucache_get_project_count(c, w); p++)
+                visit(inst, name, path, ucache_get_project(c, w, p));
+        }
+        return;
+    }
+    if (obj->workspace_filter) {
+        workspace **w = workspace_map_get(
+                &obj->workspace_by_alias, obj->workspace_filter);
+        if (w)
+            workspace_accept(*w, inst, visit);
+        return;
+    }
+    VECTOR_FOREACH(workspace *, w, &obj->workspaces)
+        workspace_accept(*w, inst, visit);
 }
 
 const char *universe_get_workspace_path(universe *obj, const char *alias)
 {
-    workspace *w = hash_map_get(obj->workspace_by_alias, (char *)alias);
-    return w ? workpace_get_path(w) : NULL;
+    if (obj->workspace_filter && strcmp(obj->workspace_filter, alias))
+        return NULL;
+    if (obj->cache) {
+        int w = ucache_find_workspace(obj->cache, alias);
+        return w < 0 ? NULL : ucache_get_workspace_path(obj->cache, w);
+    }
+    workspace **w = workspace_map_get(&obj->workspace_by_alias, alias);
+    return w ? workpace_get_path(*w) : NULL;
 }
 
-/* Frees the memory allocated to the specified character sequence */
-static void destroy_string(void *inst, void *s)
+void universe_destroy(universe *obj)
 {
-    (void)inst; /* unused when DEBUG not defined */
-    DEBUG_LOG(((universe *)inst)->logger, "Destroying string '%s'...\n",
-            (char *)s);
-    free(s);
+    err_publisher_destroy(obj->err_publisher);
+    VECTOR_FOREACH(workspace *, w, &obj->workspaces)
+        workspace_destroy(*w);
+    workspace_vector_destroy(&obj->workspaces);
+    dparser_destroy(obj->parser);
+    string_vector_destroy(&obj->default_projects);
+    workspace_map_destroy(&obj->workspace_by_alias);
+    /* The workspaces borrow their names and projects from the pool, so it
+     * goes last, freeing all the strings at once.
+     */
+    str_pool_destroy(obj->strings);
+    if (obj->cache)
+        ucache_close(obj->cache);
+    free(obj->dconsumer);
+    free(obj);
 }
 
-/* Frees the memory allocated too the specified key and value of workspace
- * type.
+/*
+ * Parses the definitions read from the specified stream chunk by chunk.
  */
-static void destroy_key_value(void *inst, char *key, void *value)
+static const char *parse_stream(universe *obj, FILE *infile)
 {
-    (void)inst; /* unused when DEBUG not defined */
-    (void)key; /* key is freed by hashmap */
-    DEBUG_LOG(((universe *)inst)->logger, "Destroying key '%s'...\n",
-            (char *)key);
-    //	free(key);
-    workspace_destroy(value);
+    char chunk[PARSE_CHUNK_SIZE];
+    size_t len;
+    const char *err_msg = NULL;
+    while (!err_msg && !dparser_is_stopped(obj->parser) &&
+            (len = fread(chunk, 1, sizeof(chunk), infile)) > 0)
+        err_msg = dparser_proc_buffer(obj->parser, chunk, len);
+    return err_msg;
 }
 
-void universe_destroy(universe *obj)
+#ifndef _WIN32
+/*
+ * Maps the specified file into memory and parses it in one go. Returns false
+ * if the file cannot be mapped, such as a pipe or a special file.
+ */
+static bool parse_mapped(universe *obj, int fd, const char **err_msg)
 {
-    err_publisher_destroy(obj->err_publisher);
-    linked_list_destroy(obj->workspaces);
-    dparser_destroy(obj->parser);
-    /* Remove the dynamically allocated project strings before destroying
-     * the list that holds them.
-     */
-    linked_list_traverse(obj->default_projects, obj, destroy_string);
-    linked_list_destroy(obj->default_projects);
-
-    /* Remove the dynamically allocated keys and values */
-    hash_map_traverse(obj->workspace_by_alias, obj, destroy_key_value);
-    hash_map_destroy(obj->workspace_by_alias);
-
-    /* Remove the dynamically allocated custom project names along with
-     * the list that contains them.
-     */
-    linked_list_traverse(obj->alloc_strings, obj, destroy_string);
-    linked_list_destroy(obj->alloc_strings);
-    free(obj->dconsumer);
-    free(obj);
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return false;
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return false;
+    /* The names are interned, so the mapping is not needed afterwards */
+    *err_msg = dparser_proc_buffer(obj->parser, map, st.st_size);
+    if (obj->caching) {
+        obj->source.size = st.st_size;
+        obj->source.mtime_ns = ucache_mtime_ns(&st);
+        obj->source.hash = ucache_hash(map, st.st_size);
+        obj->source_known = true;
+    }
+    munmap(map, st.st_size);
+    return true;
 }
+#endif
 
 /*
  * Parses the specified file containing repository and workspace defintions.
+ * Regular files are mapped into memory, the rest are read through stdio.
  */
 static void parse_file(universe *obj, const char *file_name)
 {
-    int c;
+    const char *err_msg = NULL;
+#ifndef _WIN32
+    int fd = open(file_name, O_RDONLY);
+    if (fd >= 0 && parse_mapped(obj, fd, &err_msg)) {
+        close(fd);
+        obj->err_msg = err_msg;
+        if (err_msg)
+            err_publisher_fire(obj->err_publisher, 0, err_msg);
+        return;
+    }
+    FILE *infile = fd >= 0 ? fdopen(fd, "r") : NULL;
+    if (!infile && fd >= 0)
+        close(fd);
+#else
     FILE *infile = fopen(file_name, "r");
+#endif
     if (!infile) {
         err_publisher_fire(
                 obj->err_publisher, 0, "File not found: %s", file_name);
         return;
     }
-    /* Process the file */
-    register const char *err_msg = NULL;
-    while ((c = fgetc(infile)) != EOF && !err_msg)
-        err_msg = dparser_proc_char(obj->parser, c);
+    err_msg = parse_stream(obj, infile);
     fclose(infile);
+    obj->err_msg = err_msg;
     if (err_msg)
         err_publisher_fire(obj->err_publisher, 0, err_msg);
 }
 
-/**
- * Adds a project to the specified instance of the workspace.
- */
-static void add_to_workspace(void *inst, void *project)
-{
-    workspace_add_dir(inst, project);
-}
-
-static void add_project(void *inst, const char *project)
+static void add_project(void *inst, const char *project, size_t len)
 {
     universe *obj = inst;
-    DEBUG_LOG(obj->logger, "universe: add_project: %s\n", project);
-    /* Duplicate the project character sequence as the original is mutable.
-     * The duplicates will be destroyed immediately before the list is.
-     */
-    linked_list_add(obj->default_projects, strdup(project));
+    DEBUG_LOG(obj->logger, "universe: add_project: %.*s\n", (int)len,
+            project);
+    /* Intern the project name as the original is transient */
+    string_vector_push(&obj->default_projects,
+            str_pool_intern_n(obj->strings, project, len));
 }
 
-static void add_workspace(void *inst, const char *alias, const char *path)
+static void add_workspace(void *inst, const char *alias, size_t alias_len,
+        const char *path, size_t path_len)
 {
     universe *obj = inst;
-    DEBUG_LOG(obj->logger, "universe: add_workspace: '%s' -> '%s'\n", alias,
-            path);
-    workspace *workspace = hash_map_get(obj->workspace_by_alias, (char *)alias);
+    DEBUG_LOG(obj->logger, "universe: add_workspace: '%.*s' -> '%.*s'\n",
+            (int)alias_len, alias, (int)path_len, path);
+    alias = str_pool_intern_n(obj->strings, alias, alias_len);
+    workspace **found = workspace_map_get(&obj->workspace_by_alias, alias);
+    workspace *workspace = found ? *found : NULL;
     if (!workspace) {
-        /* The alias copies used as the keys and the workspaces will be
-         * explicitly garbage-collected when before the map is destroyed
-         * in unverse_destroy(universe *)
-         */
-        char *alias_copy = strdup(alias);
-        char *path_copy = strdup(path);
-        /* Register the newly allocated alias and path copies as dynamically
-         * allocated so that they can be garbage-collected before destruction.
-         */
-        linked_list_add(obj->alloc_strings, alias_copy);
-        linked_list_add(obj->alloc_strings, path_copy);
-        workspace = workspace_new(alias_copy, path_copy);
-        linked_list_add(obj->workspaces, workspace);
-        hash_map_put(obj->workspace_by_alias, alias_copy, workspace);
+        workspace = workspace_new(
+                alias, str_pool_intern_n(obj->strings, path, path_len));
+        workspace_vector_push(&obj->workspaces, workspace);
+        workspace_map_put(&obj->workspace_by_alias, alias, workspace);
+        /* The path is all that is needed, and it cannot change */
+        if (obj->path_only)
+            dparser_stop(obj->parser);
     }
-    linked_list_traverse(obj->default_projects, workspace, add_to_workspace);
+    VECTOR_FOREACH(const char *, project, &obj->default_projects)
+        workspace_add_dir(workspace, *project);
 }
 
-static void add_workspace_project(
-        void *inst, const char *alias, const char *project)
+static void add_workspace_project(void *inst, const char *alias,
+        size_t alias_len, const char *project, size_t project_len)
 {
     universe *obj = inst;
     DEBUG_LOG(obj->logger,
-            "universe: add_workspace_project: alias=%s, project=%s\n", alias,
-            project);
-    workspace *workspace = hash_map_get(obj->workspace_by_alias, (char *)alias);
+            "universe: add_workspace_project: alias=%.*s, project=%.*s\n",
+            (int)alias_len, alias, (int)project_len, project);
+    alias = str_pool_intern_n(obj->strings, alias, alias_len);
+    workspace **workspace = workspace_map_get(&obj->workspace_by_alias, alias);
     if (workspace) {
-        /* We need to copy the project name as it can mutate later */
-        char *project_copy = strdup(project);
-        /* Put on the list of custom projects so that we can GC it later */
-        linked_list_add(obj->alloc_strings, project_copy);
-        workspace_add_dir(workspace, project_copy);
+        /* Intern the project name as the original is transient */
+        workspace_add_dir(*workspace,
+                str_pool_intern_n(obj->strings, project, project_len));
     }
 }
 
@@ -34,12 +34,36 @@
 #ifndef UNIVERSE_H_
 #define UNIVERSE_H_
 
+#include <stdbool.h>
 #include "logger.h"
 
 typedef struct universe_st universe;
 
 universe *universe_new(
         logger *, const char *, void *, void (*)(void *, int, const char *));
+
+/*
+ * Construction options of the universe.
+ */
+struct universe_options {
+    /*
+     * Read the universe from the image cached next to the definition file if
+     * it is up to date, and write the image after parsing otherwise
+     */
+    bool cache;
+    /* Parse and write the image even if it is up to date */
+    bool rebuild_cache;
+    /* The alias of the only workspace to materialise or NULL for all */
+    const char *workspace;
+    /* Stop parsing as soon as the workspace is declared, which is enough
+     * to look up its path */
+    bool path_only;
+};
+
+universe *universe_new_ex(logger *, const char *,
+        const struct universe_options *, void *,
+        void (*)(void *, int, const char *));
+
 void universe_accept(universe *, void *,
         void (*)(void *, const char *, const char *, const char *));
 const char *universe_get_workspace_path(universe *, const char *);
@@ -30,12 +30,26 @@
  *
  * utils.c
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include "utils.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "alloctrace.h"
 
-char *strdup(const char *s)
+#ifdef _WIN32
+#define PATH_LIST_SEPARATOR ';'
+#else
+#define PATH_LIST_SEPARATOR ':'
+#endif
+
+/* The name is parenthesised so that it is not replaced by alloctrace.h */
+char *(strdup)(const char *s)
 {
     size_t len = strlen(s) + 1;
     char *p = malloc(len);
@@ -64,3 +78,61 @@ char path_separator()
     return '/';
 #endif
 }
+
+bool find_executable(const char *name, char *dst, int len)
+{
+    const char *dirs = getenv("PATH");
+    char sep = path_separator();
+    const char sep_str[] = {sep, 0};
+    char cwd[MAX_PATH];
+    if (!dirs || !getcwd(cwd, sizeof(cwd) - 1))
+        return false;
+    /* The commands are run from the project directories, so the relative
+     * (and empty) entries are resolved against the current directory
+     */
+    size_t cwd_len = strlen(cwd);
+    if (cwd[cwd_len - 1] != sep) {
+        cwd[cwd_len++] = sep;
+        cwd[cwd_len] = 0;
+    }
+    /* The leading, inner and trailing empty entries all stand for it */
+    const char *dirs_end = dirs + strlen(dirs);
+    for (;;) {
+        const char *end = memchr(dirs, PATH_LIST_SEPARATOR, dirs_end - dirs);
+        if (!end)
+            end = dirs_end;
+        int dir_len = end - dirs;
+        const char *base = dir_len && dirs[0] == sep ? "" : cwd;
+        int n = snprintf(dst, len, "%s%.*s%s%s", base, dir_len, dirs,
+                dir_len && dirs[dir_len - 1] != sep ? sep_str : "", name);
+        struct stat st;
+        if (n < len && !stat(dst, &st) && S_ISREG(st.st_mode) &&
+                !access(dst, X_OK))
+            return true;
+        if (end == dirs_end)
+            return false;
+        dirs = end + 1;
+    }
+}
+
+bool write_fully(int fd, const void *buffer, size_t len)
+{
+    const char *src = buffer;
+    while (len) {
+        ssize_t n = write(fd, src, len);
+        if (n < 0 && errno != EINTR)
+            return false;
+        if (n > 0) {
+            src += n;
+            len -= n;
+        }
+    }
+    return true;
+}
+
+long long clock_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
@@ -34,6 +34,9 @@
 #ifndef UTILS_H_
 #define UTILS_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #define MAX_PATH 1024
 
 /*
@@ -52,4 +55,22 @@ char *get_home();
  */
 char path_separator();
 
+/*
+ * Looks up the executable file with the specified name in the directories
+ * listed by the PATH environment variable and writes its absolute path to
+ * the destination of the specified length. Returns false if there is none.
+ */
+bool find_executable(const char *, char *, int);
+
+/*
+ * Writes the specified bytes to the file descriptor, resuming the write if
+ * it is interrupted or partial. Returns false on error.
+ */
+bool write_fully(int, const void *, size_t);
+
+/*
+ * Returns the monotonic clock reading in nanoseconds.
+ */
+long long clock_ns();
+
 #endif /* UTILS_H_ */
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * where.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "where.h"
+#include <ctype.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "containers.h"
+#include "proc.h"
+#include "strpool.h"
+#include "utils.h"
+#include "xsystem.h"
+#include "alloctrace.h"
+
+/* The probes only look at whether there is any output or at two counts */
+#define PROBE_BUFFER_LEN 64
+
+enum node_type {
+    W_OR,
+    W_AND,
+    W_NOT,
+    W_NAME,
+    W_WORKSPACE,
+    W_BRANCH,
+    W_DIRTY,
+    W_CLEAN,
+    W_AHEAD,
+    W_BEHIND
+};
+
+static const struct {
+    const char *name;
+    enum node_type type;
+    /* Whether the predicate compares against a glob */
+    bool glob;
+    /*
+     * Relative cost of the evaluation: the names are at hand, the branch
+     * takes a file read and the rest take a Git run
+     */
+    int cost;
+} PREDICATES[] = {{"name", W_NAME, true, 0},
+        {"workspace", W_WORKSPACE, true, 0}, {"branch", W_BRANCH, true, 1},
+        {"dirty", W_DIRTY, false, 2}, {"clean", W_CLEAN, false, 2},
+        {"ahead", W_AHEAD, false, 2}, {"behind", W_BEHIND, false, 2}};
+
+struct node {
+    enum node_type type;
+    /* The highest cost of the predicates in the subtree */
+    int cost;
+    /* The operands of the operators */
+    int left;
+    int right;
+    /* The glob of the predicate and whether it must not match */
+    const char *pattern;
+    bool negate;
+};
+
+DECLARE_VECTOR(node_vector, struct node)
+
+enum probe_state { NOT_PROBED, PROBE_FAILED, PROBED };
+
+/*
+ * The job being matched along with the results of the probes run so far, so
+ * that every probe runs at most once per job.
+ */
+struct subject {
+    const char *workspace;
+    const char *project;
+    const char *path;
+    enum probe_state head;
+    char branch[MAX_PATH];
+    enum probe_state status;
+    bool dirty;
+    enum probe_state upstream;
+    int ahead;
+    int behind;
+};
+
+struct where_st {
+    struct node_vector nodes;
+    int root;
+    str_pool *patterns;
+    struct subject subject;
+    struct char_buffer *buff;
+    int probes;
+};
+
+struct parser {
+    where *obj;
+    const char *s;
+    const char *err_msg;
+};
+
+static bool is_word_char(char c)
+{
+    return isalnum((unsigned char)c) || c == '_' || c == '-';
+}
+
+static void skip_blanks(struct parser *p)
+{
+    while (isspace((unsigned char)*p->s))
+        p->s++;
+}
+
+/*
+ * Consumes the operator if it is next, either as a symbol or spelled out.
+ */
+static bool accept(struct parser *p, const char *symbol, const char *word)
+{
+    skip_blanks(p);
+    size_t len = strlen(symbol);
+    if (!strncmp(p->s, symbol, len)) {
+        p->s += len;
+        return true;
+    }
+    len = strlen(word);
+    if (!strncmp(p->s, word, len) && !is_word_char(p->s[len])) {
+        p->s += len;
+        return true;
+    }
+    return false;
+}
+
+static int fail(struct parser *p, const char *err_msg)
+{
+    if (!p->err_msg)
+        p->err_msg = err_msg;
+    return -1;
+}
+
+static int add_node(struct parser *p, struct node node)
+{
+    if (!node_vector_push(&p->obj->nodes, node))
+        return fail(p, "Out of memory");
+    return p->obj->nodes.size - 1;
+}
+
+static int add_operator(struct parser *p, enum node_type type, int left,
+        int right)
+{
+    const struct node *nodes = p->obj->nodes.items;
+    /* The operands have no side effects, so evaluate the cheaper one first */
+    if (nodes[right].cost < nodes[left].cost) {
+        int tmp = left;
+        left = right;
+        right = tmp;
+    }
+    struct node node = {type, nodes[right].cost, left, right, NULL, false};
+    return add_node(p, node);
+}
+
+static bool is_pattern_end(const char *s)
+{
+    return !*s || isspace((unsigned char)*s) || *s == '(' || *s == ')' ||
+            (s[0] == '&' && s[1] == '&') || (s[0] == '|' && s[1] == '|');
+}
+
+static int parse_predicate(struct parser *p)
+{
+    skip_blanks(p);
+    const char *name = p->s;
+    while (is_word_char(*p->s))
+        p->s++;
+    size_t len = p->s - name;
+    if (!len)
+        return fail(p, "Predicate expected in where expression");
+
+    int i = 0;
+    int count = sizeof(PREDICATES) / sizeof(PREDICATES[0]);
+    while (i < count && (strlen(PREDICATES[i].name) != len ||
+                                strncmp(PREDICATES[i].name, name, len)))
+        i++;
+    if (i == count)
+        return fail(p, "Unknown predicate in where expression");
+
+    struct node node = {
+            PREDICATES[i].type, PREDICATES[i].cost, -1, -1, NULL, false};
+    if (PREDICATES[i].glob) {
+        skip_blanks(p);
+        if (p->s[0] == '!' && p->s[1] == '=') {
+            node.negate = true;
+            p->s++;
+        } else if (*p->s != '=') {
+            return fail(p, "Comparison expected in where expression");
+        }
+        p->s++;
+        skip_blanks(p);
+        const char *pattern = p->s;
+        while (!is_pattern_end(p->s))
+            p->s++;
+        if (p->s == pattern)
+            return fail(p, "Pattern expected in where expression");
+        node.pattern =
+                str_pool_intern_n(p->obj->patterns, pattern, p->s - pattern);
+        if (!node.pattern)
+            return fail(p, "Out of memory");
+    }
+    return add_node(p, node);
+}
+
+static int parse_or(struct parser *);
+
+static int parse_unary(struct parser *p)
+{
+    if (accept(p, "!", "not")) {
+        int operand = parse_unary(p);
+        if (operand < 0)
+            return -1;
+        struct node node = {W_NOT, p->obj->nodes.items[operand].cost, operand,
+                -1, NULL, false};
+        return add_node(p, node);
+    }
+    if (accept(p, "(", "(")) {
+        int n = parse_or(p);
+        if (n < 0)
+            return -1;
+        if (!accept(p, ")", ")"))
+            return fail(p, "Missing ) in where expression");
+        return n;
+    }
+    return parse_predicate(p);
+}
+
+static int parse_and(struct parser *p)
+{
+    int left = parse_unary(p);
+    while (left >= 0 && accept(p, "&&", "and")) {
+        int right = parse_unary(p);
+        if (right < 0)
+            return -1;
+        left = add_operator(p, W_AND, left, right);
+    }
+    return left;
+}
+
+static int parse_or(struct parser *p)
+{
+    int left = parse_and(p);
+    while (left >= 0 && accept(p, "||", "or")) {
+        int right = parse_and(p);
+        if (right < 0)
+            return -1;
+        left = add_operator(p, W_OR, left, right);
+    }
+    return left;
+}
+
+where *where_new(const char *expr, const char **err_msg)
+{
+    where *obj = malloc(sizeof(struct where_st));
+    node_vector_init(&obj->nodes);
+    obj->patterns = str_pool_new();
+    obj->buff = char_buffer_new(PROBE_BUFFER_LEN);
+    obj->probes = 0;
+
+    struct parser p = {obj, expr, NULL};
+    obj->root = parse_or(&p);
+    skip_blanks(&p);
+    if (obj->root >= 0 && *p.s)
+        fail(&p, "Unexpected input in where expression");
+    if (p.err_msg) {
+        *err_msg = p.err_msg;
+        where_destroy(obj);
+        return NULL;
+    }
+    return obj;
+}
+
+/*
+ * Reads the first line of the file without the line break.
+ */
+static bool read_line(const char *file_name, char *dst, int len)
+{
+    FILE *file = fopen(file_name, "r");
+    if (!file)
+        return false;
+    bool ok = fgets(dst, len, file) != NULL;
+    fclose(file);
+    if (ok)
+        dst[strcspn(dst, "\r\n")] = 0;
+    return ok;
+}
+
+/*
+ * Reads the current branch from HEAD without running Git. The Git directory
+ * of a linked work tree or a submodule is referred to by a .git file.
+ */
+static bool read_head(where *obj)
+{
+    struct subject *s = &obj->subject;
+    if (s->head != NOT_PROBED)
+        return s->head == PROBED;
+    s->head = PROBE_FAILED;
+
+    char sep = path_separator();
+    char file_name[MAX_PATH];
+    char line[MAX_PATH];
+    snprintf(file_name, MAX_PATH, "%s%c.git%cHEAD", s->path, sep, sep);
+    if (!read_line(file_name, line, MAX_PATH)) {
+        snprintf(file_name, MAX_PATH, "%s%c.git", s->path, sep);
+        if (!read_line(file_name, line, MAX_PATH) ||
+                strncmp(line, "gitdir: ", 8))
+            return false;
+        /* The Git directory may be relative to the work tree */
+        const char *dir = line + 8;
+        if (*dir == '/')
+            snprintf(file_name, MAX_PATH, "%s%cHEAD", dir, sep);
+        else
+            snprintf(file_name, MAX_PATH, "%s%c%s%cHEAD", s->path, sep, dir,
+                    sep);
+        if (!read_line(file_name, line, MAX_PATH))
+            return false;
+    }
+
+    /* A detached HEAD holds a commit id, which Git reports as "HEAD" */
+    if (!strncmp(line, "ref: refs/heads/", 16))
+        snprintf(s->branch, MAX_PATH, "%s", line + 16);
+    else if (!strncmp(line, "ref: ", 5))
+        snprintf(s->branch, MAX_PATH, "%s", line + 5);
+    else
+        strcpy(s->branch, "HEAD");
+    s->head = PROBED;
+    return true;
+}
+
+/*
+ * Runs Git with the specified arguments in the project directory.
+ */
+static bool run_git(where *obj, const char *args)
+{
+    const char *path = obj->subject.path;
+    /* The path is quoted for the shell */
+    if (strchr(path, '\'') || strlen(path) + strlen(args) + 16 > MAX_PATH)
+        return false;
+    char git_args[MAX_PATH];
+    snprintf(git_args, MAX_PATH, "-C '%s' %s 2>/dev/null", path, args);
+    char cmd[PROC_GIT_CMD_LEN];
+    obj->probes++;
+    char_buffer_reset(obj->buff);
+    return !xsystem(proc_git_command(cmd, git_args), obj->buff, false);
+}
+
+static bool probe_status(where *obj)
+{
+    struct subject *s = &obj->subject;
+    if (s->status == NOT_PROBED) {
+        s->status = PROBE_FAILED;
+        if (run_git(obj, PROC_CMD_STATUS)) {
+            s->dirty = char_buffer_len(obj->buff) > 0;
+            s->status = PROBED;
+        }
+    }
+    return s->status == PROBED;
+}
+
+static bool probe_upstream(where *obj)
+{
+    struct subject *s = &obj->subject;
+    if (s->upstream == NOT_PROBED) {
+        s->upstream = PROBE_FAILED;
+        if (run_git(obj, PROC_CMD_AHEAD_BEHIND)) {
+            /* The output is "<ahead>\t<behind>\n" */
+            struct char_buffer *buff = obj->buff;
+            char counts[PROBE_BUFFER_LEN + 1];
+            int len = char_buffer_len(buff);
+            memcpy(counts, buff->buffer + buff->position, len);
+            counts[len] = 0;
+            if (sscanf(counts, "%d %d", &s->ahead, &s->behind) == 2)
+                s->upstream = PROBED;
+        }
+    }
+    return s->upstream == PROBED;
+}
+
+static bool match_glob(const struct node *node, const char *s)
+{
+    return !fnmatch(node->pattern, s, 0) != node->negate;
+}
+
+/*
+ * Evaluates the subtree with short-circuiting, so the probes of the operand
+ * on the right run only if the one on the left does not decide.
+ */
+static bool eval(where *obj, int n)
+{
+    const struct node *node = &obj->nodes.items[n];
+    struct subject *s = &obj->subject;
+    switch (node->type) {
+    case W_OR:
+        return eval(obj, node->left) || eval(obj, node->right);
+    case W_AND:
+        return eval(obj, node->left) && eval(obj, node->right);
+    case W_NOT:
+        return !eval(obj, node->left);
+    case W_NAME:
+        return match_glob(node, s->project);
+    case W_WORKSPACE:
+        return match_glob(node, s->workspace);
+    case W_BRANCH:
+        return read_head(obj) && match_glob(node, s->branch);
+    case W_DIRTY:
+        return probe_status(obj) && s->dirty;
+    case W_CLEAN:
+        return probe_status(obj) && !s->dirty;
+    case W_AHEAD:
+        return probe_upstream(obj) && s->ahead > 0;
+    default:
+        return probe_upstream(obj) && s->behind > 0;
+    }
+}
+
+bool where_match(where *obj, const char *workspace, const char *project,
+        const char *project_path)
+{
+    struct subject *s = &obj->subject;
+    s->workspace = workspace;
+    s->project = project;
+    s->path = project_path;
+    s->head = s->status = s->upstream = NOT_PROBED;
+    return eval(obj, obj->root);
+}
+
+int where_get_probe_count(where *obj)
+{
+    return obj->probes;
+}
+
+void where_destroy(where *obj)
+{
+    node_vector_destroy(&obj->nodes);
+    str_pool_destroy(obj->patterns);
+    char_buffer_destroy(obj->buff);
+    free(obj);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * where.h
+ *
+ * Repository selection expressions. An expression is compiled once and then
+ * matched against every job, e.g.
+ *
+ *     dirty && branch!=master
+ *     name=lib* || (workspace=tools && !ahead)
+ *
+ * The predicates are name, workspace and branch compared against a glob with
+ * = or !=, and dirty, clean, ahead and behind, combined with &&, ||, ! (or
+ * and, or, not) and parentheses. Cheap predicates are evaluated before the
+ * ones that have to run Git, so the latter only run for the survivors.
+ */
+
+#ifndef WHERE_H_
+#define WHERE_H_
+
+#include <stdbool.h>
+
+typedef struct where_st where;
+
+/*
+ * Compiles the specified expression. Returns NULL and sets the error message
+ * if the expression is invalid.
+ */
+where *where_new(const char *, const char **);
+
+/*
+ * Returns true if the project with the specified workspace name, project name
+ * and project path satisfies the expression. A predicate that cannot be
+ * evaluated (e.g. the project is not a repository) does not hold.
+ */
+bool where_match(where *, const char *, const char *, const char *);
+
+/*
+ * Returns the number of Git commands run by the matches so far.
+ */
+int where_get_probe_count(where *);
+
+void where_destroy(where *);
+
+#endif /* WHERE_H_ */
@@ -34,13 +34,12 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "linkedhashset.h"
+#include "alloctrace.h"
 
 struct workspace_st {
     const char *name;
     const char *path;
     linked_hash_set *projects;
-    void (*visit)(void *, const char *, const char *, const char *);
-    void *inst;
 };
 
 workspace *workspace_new(const char *name, const char *path)
@@ -56,21 +55,19 @@ workspace *workspace_new(const char *name, const char *path)
 
 void workspace_add_dir(workspace *obj, const char *dir)
 {
-    linked_hash_set_add(obj->projects, (char *)dir);
+    linked_hash_set_add(obj->projects, dir);
 }
 
-static void visit_list_item(void *inst, void *project)
+void workspace_accept(workspace *obj, void *inst,
+        void (*visit)(void *, const char *, const char *, const char *))
 {
-    workspace *obj = inst;
-    obj->visit(obj->inst, obj->name, obj->path, project);
+    LINKED_HASH_SET_FOREACH(project, obj->projects)
+        visit(inst, obj->name, obj->path, *project);
 }
 
-void workspace_accept(workspace *obj, void *inst,
-        void (*visit)(void *, const char *, const char *, const char *))
+const char *workspace_get_name(workspace *obj)
 {
-    obj->inst = inst;
-    obj->visit = visit;
-    linked_hash_set_traverse(obj->projects, obj, visit_list_item);
+    return obj->name;
 }
 
 const char *workpace_get_path(workspace *obj)
@@ -78,6 +75,16 @@ const char *workpace_get_path(workspace *obj)
     return obj->path;
 }
 
+const char *const *workspace_get_projects(workspace *obj)
+{
+    return linked_hash_set_items(obj->projects);
+}
+
+int workspace_get_project_count(workspace *obj)
+{
+    return linked_hash_set_get_size(obj->projects);
+}
+
 void workspace_destroy(workspace *obj)
 {
     linked_hash_set_destroy(obj->projects);
@@ -52,11 +52,24 @@ void workspace_add_dir(workspace *, const char *);
 void workspace_accept(workspace *, void *,
         void (*)(void *, const char *, const char *, const char *));
 
+/*
+ * Returns the name (alias) of this workspace.
+ */
+const char *workspace_get_name(workspace *);
+
 /*
  * Returns the path to this workspace.
  */
 const char *workpace_get_path(workspace *);
 
+/*
+ * Returns the project directories in the order they were added. The array
+ * is valid until the next directory is added.
+ */
+const char *const *workspace_get_projects(workspace *);
+
+int workspace_get_project_count(workspace *);
+
 /**
  * Releases the resources claimed by the workspace and destroys it.
  */
@@ -30,19 +30,58 @@
  *
  * xsystem.c
  */
-#define _BSD_SOURCE
+#define _GNU_SOURCE
 
 #include "xsystem.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#ifndef _WIN32
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "utils.h"
+#include "alloctrace.h"
 
 #if !defined(pipe) && defined(__MINGW32__)
 #define pipe(fds) _pipe(fds, 8192, 0)
 #endif
 
+/*
+ * The default spawning strategy can be overridden at build time, e.g.
+ * make SPAWN=vfork
+ */
+#ifndef XSYSTEM_SPAWN
+#ifdef _WIN32
+#define XSYSTEM_SPAWN "popen"
+#else
+#define XSYSTEM_SPAWN "posix_spawn"
+#endif
+#endif
+
+#define SHELL "/bin/sh"
+#define READ_BUFFER_LEN 4096
+/* Bytes moved by a single splice() call */
+#define SPLICE_LEN (1 << 20)
+#define CLONE_STACK_LEN (64 * 1024)
+
+extern char **environ;
+
+static const char *STRATEGY_NAMES[] = {
+        "popen", "fork", "vfork", "posix_spawn", "clone"};
+
+static bool strategy_initialised = false;
+static long long bytes_read = 0;
+static enum spawn_strategy strategy;
+
 struct char_buffer *char_buffer_new(int length)
 {
     char *buffer = malloc(length);
@@ -82,17 +121,64 @@ void char_buffer_print(struct char_buffer *obj)
     }
 }
 
-int xsystem(const char *cmd, struct char_buffer *dst, bool verbose)
+bool xsystem_parse_strategy(const char *name, enum spawn_strategy *dst)
 {
-    /*
-     * Flush stdout as the command might take a while to execute leaving
-     * the output split.
-     */
-    fflush(stdout);
+    for (int i = 0; i < (int)(sizeof(STRATEGY_NAMES) / sizeof(char *)); i++) {
+        if (strcmp(name, STRATEGY_NAMES[i]))
+            continue;
+#ifdef _WIN32
+        if (i != SPAWN_POPEN)
+            return false;
+#elif !defined(__linux__)
+        if (i == SPAWN_CLONE)
+            return false;
+#endif
+        *dst = (enum spawn_strategy)i;
+        return true;
+    }
+    return false;
+}
 
-    if (!dst)
-        return system(cmd);
+const char *xsystem_strategy_name(enum spawn_strategy strategy)
+{
+    return STRATEGY_NAMES[strategy];
+}
+
+void xsystem_set_strategy(enum spawn_strategy s)
+{
+    strategy = s;
+    strategy_initialised = true;
+}
+
+enum spawn_strategy xsystem_get_strategy()
+{
+    if (!strategy_initialised) {
+        if (!xsystem_parse_strategy(XSYSTEM_SPAWN, &strategy))
+            strategy = SPAWN_POPEN;
+        strategy_initialised = true;
+    }
+    return strategy;
+}
+
+/*
+ * Appends the specified bytes to the destination buffer, discarding what does
+ * not fit, and echoes them to stdout in the verbose mode.
+ */
+static void capture(
+        struct char_buffer *dst, const char *src, int len, bool verbose)
+{
+    bytes_read += len;
+    if (verbose)
+        fwrite(src, 1, len, stdout);
+    int room = dst->limit - dst->position;
+    if (len > room)
+        len = room;
+    memcpy(dst->buffer + dst->position, src, len);
+    dst->position += len;
+}
 
+static int xsystem_popen(const char *cmd, struct char_buffer *dst, bool verbose)
+{
     FILE *fp = popen(cmd, "r");
     if (!fp) {
         fprintf(stderr, "Error popen with %s\n", cmd);
@@ -100,16 +186,13 @@ int xsystem(const char *cmd, struct char_buffer *dst, bool verbose)
         return 1;
     }
 
-    int ch;
+    char buffer[READ_BUFFER_LEN];
     int prev_position = dst->position;
+    size_t len;
 
     // Read from the process and print
-    while ((ch = fgetc(fp)) != EOF) {
-        if (verbose)
-            putchar(ch);
-        if (dst->position < dst->limit)
-            dst->buffer[dst->position++] = ch;
-    }
+    while ((len = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        capture(dst, buffer, (int)len, verbose);
 
     // Flip char_buffer
     dst->limit = dst->position;
@@ -117,3 +200,214 @@ int xsystem(const char *cmd, struct char_buffer *dst, bool verbose)
 
     return pclose(fp);
 }
+
+#ifndef _WIN32
+/*
+ * The command line of the shell that runs the command.
+ */
+struct shell_args {
+    const char *argv[4];
+    int out_fd;
+    int unused_fd;
+};
+
+static void init_shell_args(struct shell_args *args, const char *cmd, int *fds)
+{
+    args->argv[0] = "sh";
+    args->argv[1] = "-c";
+    args->argv[2] = cmd;
+    args->argv[3] = NULL;
+    args->unused_fd = fds[0];
+    args->out_fd = fds[1];
+}
+
+/*
+ * Redirects the output and replaces the child process image with the shell.
+ * Only async-signal-safe calls are allowed here as the child may share
+ * the memory of the parent.
+ */
+static int exec_child(void *inst)
+{
+    struct shell_args *args = inst;
+    close(args->unused_fd);
+    if (args->out_fd != STDOUT_FILENO) {
+        dup2(args->out_fd, STDOUT_FILENO);
+        close(args->out_fd);
+    }
+    execve(SHELL, (char *const *)args->argv, environ);
+    _exit(127);
+    return 127;
+}
+
+static pid_t spawn(enum spawn_strategy strategy, struct shell_args *args)
+{
+    pid_t pid = -1;
+    switch (strategy) {
+    case SPAWN_FORK:
+        if (!(pid = fork()))
+            exec_child(args);
+        break;
+    case SPAWN_VFORK:
+        if (!(pid = vfork()))
+            exec_child(args);
+        break;
+#ifdef __linux__
+    case SPAWN_CLONE: {
+        /*
+         * The child borrows our address space and runs on this stack frame
+         * while we are suspended until it calls execve()
+         */
+        long stack[CLONE_STACK_LEN / sizeof(long)];
+        pid = clone(exec_child, stack + CLONE_STACK_LEN / sizeof(long),
+                CLONE_VM | CLONE_VFORK | SIGCHLD, args);
+        break;
+    }
+#endif
+    default: {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addclose(&actions, args->unused_fd);
+        posix_spawn_file_actions_adddup2(
+                &actions, args->out_fd, STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, args->out_fd);
+        if (posix_spawn(&pid, SHELL, &actions, NULL,
+                    (char *const *)args->argv, environ))
+            pid = -1;
+        posix_spawn_file_actions_destroy(&actions);
+        break;
+    }
+    }
+    return pid;
+}
+
+/*
+ * Passes the output of the command through to stdout, capturing as much of
+ * it as fits the buffer. Once the buffer is full, the rest is moved from the
+ * pipe to stdout by the kernel on Linux without being copied here, unless
+ * stdout cannot be spliced to (e.g. a terminal).
+ */
+static void pass_through(int fd, struct char_buffer *dst)
+{
+    char buffer[READ_BUFFER_LEN];
+#ifdef __linux__
+    bool splice_out = true;
+#endif
+    while (true) {
+#ifdef __linux__
+        if (splice_out && dst->position == dst->limit) {
+            ssize_t len = splice(
+                    fd, NULL, STDOUT_FILENO, NULL, SPLICE_LEN, SPLICE_F_MOVE);
+            if (len > 0) {
+                bytes_read += len;
+                continue;
+            }
+            if (!len)
+                break;
+            if (errno == EINTR)
+                continue;
+            splice_out = false;
+        }
+#endif
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            break;
+        capture(dst, buffer, (int)len, false);
+        write_fully(STDOUT_FILENO, buffer, len);
+    }
+}
+
+static int xsystem_spawn(enum spawn_strategy strategy, const char *cmd,
+        struct char_buffer *dst, bool verbose)
+{
+    int fds[2];
+    struct shell_args args;
+    if (pipe(fds)) {
+        fprintf(stderr, "Error pipe with %s\n", cmd);
+        dst->position = dst->limit = 0;
+        return 1;
+    }
+    init_shell_args(&args, cmd, fds);
+    pid_t pid = spawn(strategy, &args);
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        fprintf(stderr, "Error spawning %s\n", cmd);
+        dst->position = dst->limit = 0;
+        return 1;
+    }
+
+    int prev_position = dst->position;
+    if (verbose) {
+        /* The output goes to stdout directly, after what is buffered */
+        fflush(stdout);
+        pass_through(fds[0], dst);
+    } else {
+        char buffer[READ_BUFFER_LEN];
+        ssize_t len;
+        while ((len = read(fds[0], buffer, sizeof(buffer))) != 0) {
+            if (len < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            capture(dst, buffer, (int)len, false);
+        }
+    }
+    close(fds[0]);
+
+    // Flip char_buffer
+    dst->limit = dst->position;
+    dst->position = prev_position;
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return 1;
+    }
+    return status;
+}
+#endif
+
+int xsystem_with(enum spawn_strategy strategy, const char *cmd,
+        struct char_buffer *dst, bool verbose)
+{
+    /*
+     * The output of the command is captured, so only the command run by
+     * system() shares stdout with us and needs what is buffered flushed
+     */
+    if (!dst) {
+        fflush(stdout);
+        return system(cmd);
+    }
+
+#ifndef _WIN32
+    if (strategy != SPAWN_POPEN)
+        return xsystem_spawn(strategy, cmd, dst, verbose);
+#endif
+    return xsystem_popen(cmd, dst, verbose);
+}
+
+int xsystem_exit_code(int status)
+{
+    if (status == -1)
+        return -1;
+#ifndef _WIN32
+    if (WIFEXITED(status))
+        return WEXITSTATUS(status);
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+#endif
+    return status;
+}
+
+long long xsystem_get_bytes_read()
+{
+    return bytes_read;
+}
+
+int xsystem(const char *cmd, struct char_buffer *dst, bool verbose)
+{
+    return xsystem_with(xsystem_get_strategy(), cmd, dst, verbose);
+}
@@ -36,6 +36,17 @@
 
 #include <stdbool.h>
 
+/*
+ * Process spawning strategies available to xsystem().
+ */
+enum spawn_strategy {
+    SPAWN_POPEN,
+    SPAWN_FORK,
+    SPAWN_VFORK,
+    SPAWN_POSIX_SPAWN,
+    SPAWN_CLONE
+};
+
 struct char_buffer {
     char *buffer;
     int position;
@@ -55,4 +66,44 @@ void char_buffer_destroy(struct char_buffer *);
  */
 int xsystem(const char *, struct char_buffer *, bool);
 
+/*
+ * Converts the status returned by xsystem() to the exit code of the command,
+ * 128 + signal number if it was killed or -1 if it could not be run.
+ */
+int xsystem_exit_code(int);
+
+/*
+ * Returns the total number of bytes read from the output of the commands
+ * executed so far, including those that did not fit into the buffers.
+ */
+long long xsystem_get_bytes_read();
+
+/*
+ * Executes the specified command with the given spawning strategy.
+ */
+int xsystem_with(
+        enum spawn_strategy, const char *, struct char_buffer *, bool);
+
+/*
+ * Sets the spawning strategy used by xsystem(). The default one is chosen
+ * at build time (see XSYSTEM_SPAWN).
+ */
+void xsystem_set_strategy(enum spawn_strategy);
+
+/*
+ * Returns the spawning strategy used by xsystem().
+ */
+enum spawn_strategy xsystem_get_strategy();
+
+/*
+ * Looks up the spawning strategy by its name. Returns false if the name is
+ * unknown or the strategy is not supported on this platform.
+ */
+bool xsystem_parse_strategy(const char *, enum spawn_strategy *);
+
+/*
+ * Returns the name of the specified spawning strategy.
+ */
+const char *xsystem_strategy_name(enum spawn_strategy);
+
 #endif /* XSYSTEM_H_ */
@@ -32,6 +32,7 @@
 #include "configtest.h"
 #include <string.h>
 #include "config.h"
+#include "logger.h"
 
 static void check_construction(tester *tst)
 {
@@ -84,6 +85,112 @@ static void check_invalid_def_file_name(tester *tst)
     config_destroy(cfg);
 }
 
+static void check_metrics_file_name(tester *tst)
+{
+    char *argv[] = {"myapp", "--metrics-file=octo.prom", "status"};
+    config *cfg = config_new();
+    tester_assert(tst, !config_parse_cmd_line(cfg, 3, argv),
+            "check_metrics_file_name");
+    char *mf = config_get_metrics_file_name(cfg);
+    tester_assert(tst, mf && !strcmp("octo.prom", mf),
+            "check_metrics_file_name");
+    tester_assert(
+            tst, config_get_opt_limit(cfg) == 2, "check_metrics_file_name");
+    argv[1] = "--metrics-file=";
+    tester_assert(tst, config_parse_cmd_line(cfg, 3, argv),
+            "check_metrics_file_name - invalid");
+    config_destroy(cfg);
+}
+
+static void check_rebuild_cache(tester *tst)
+{
+    char *argv[] = {"myapp", "--rebuild-cache", "list"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            !config_parse_cmd_line(cfg, 3, argv) &&
+                    config_is_rebuild_cache(cfg) &&
+                    config_get_opt_limit(cfg) == 2,
+            "check_rebuild_cache");
+    config_destroy(cfg);
+}
+
+static void check_resume(tester *tst)
+{
+    char *argv[] = {"myapp", "--resume", "pull"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            !config_is_resume(cfg) && !config_parse_cmd_line(cfg, 3, argv) &&
+                    config_is_resume(cfg) && config_get_opt_limit(cfg) == 2 &&
+                    strstr(config_get_journal_dir_name(cfg), ".octo") != NULL,
+            "check_resume");
+    config_destroy(cfg);
+}
+
+static void check_where(tester *tst)
+{
+    char *argv[] = {"myapp", "--where=dirty && name=a*", "list"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            !config_parse_cmd_line(cfg, 3, argv) &&
+                    !strcmp(config_get_where(cfg), "dirty && name=a*") &&
+                    config_get_opt_limit(cfg) == 2,
+            "check_where");
+    argv[1] = "--where=";
+    tester_assert(tst, config_parse_cmd_line(cfg, 3, argv) != NULL,
+            "check_where - empty");
+    config_destroy(cfg);
+}
+
+static void check_format(tester *tst)
+{
+    char *argv[] = {"myapp", "--format=json", "list"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            config_get_format(cfg) == FORMAT_TEXT &&
+                    !config_parse_cmd_line(cfg, 3, argv) &&
+                    config_get_format(cfg) == FORMAT_JSON &&
+                    config_get_opt_limit(cfg) == 2,
+            "check_format");
+    argv[1] = "--format=xml";
+    tester_assert(tst, config_parse_cmd_line(cfg, 3, argv) != NULL,
+            "check_format - invalid");
+    config_destroy(cfg);
+}
+
+static void check_jobs(tester *tst)
+{
+    char *argv[] = {"myapp", "--jobs=8", "pull"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            config_get_jobs(cfg) == 1 && !config_parse_cmd_line(cfg, 3, argv) &&
+                    config_get_jobs(cfg) == 8 &&
+                    config_get_opt_limit(cfg) == 2,
+            "check_jobs");
+    char *invalid[] = {"--jobs=0", "--jobs=", "--jobs=2x", "-j=257"};
+    for (int i = 0; i < 4; i++) {
+        argv[1] = invalid[i];
+        tester_assert(tst, config_parse_cmd_line(cfg, 3, argv) != NULL,
+                "check_jobs - invalid");
+    }
+    config_destroy(cfg);
+}
+
+static void check_log_level(tester *tst)
+{
+    char *argv[] = {"myapp", "--log-level=debug", "pull"};
+    config *cfg = config_new();
+    tester_assert(tst,
+            config_get_log_level(cfg) == LOGLEVEL_DEFAULT &&
+                    !config_parse_cmd_line(cfg, 3, argv) &&
+                    config_get_log_level(cfg) == LOGLEVEL_DEBUG &&
+                    config_get_opt_limit(cfg) == 2,
+            "check_log_level");
+    argv[1] = "--log-level=trace";
+    tester_assert(tst, config_parse_cmd_line(cfg, 3, argv) != NULL,
+            "check_log_level - invalid");
+    config_destroy(cfg);
+}
+
 void test_config(tester *tst)
 {
     tester_new_group(tst, "test_cmdline");
@@ -92,4 +199,11 @@ void test_config(tester *tst)
     check_invalid_workspace_option(tst);
     check_def_file_name(tst);
     check_invalid_def_file_name(tst);
+    check_metrics_file_name(tst);
+    check_rebuild_cache(tst);
+    check_resume(tst);
+    check_where(tst);
+    check_format(tst);
+    check_jobs(tst);
+    check_log_level(tst);
 }
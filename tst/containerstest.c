@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "containerstest.h"
+#include <stdio.h>
+#include <string.h>
+#include "containers.h"
+
+DECLARE_VECTOR(int_vector, int)
+DECLARE_STR_MAP(int_map, int)
+DECLARE_STR_SET(str_set)
+
+static void check_vector(tester *tst)
+{
+    struct int_vector v, copy;
+    int_vector_init(&v);
+    for (int i = 0; i < 100; i++)
+        int_vector_push(&v, i);
+    tester_assert(tst,
+            int_vector_size(&v) == 100 && int_vector_get(&v, 42) == 42,
+            "check_vector - push");
+    int sum = 0;
+    VECTOR_FOREACH(int, i, &v)
+        sum += *i;
+    tester_assert(tst, sum == 4950, "check_vector - foreach");
+    tester_assert(tst, int_vector_clone(&copy, &v) &&
+                    int_vector_size(&copy) == 100 &&
+                    int_vector_get(&copy, 99) == 99,
+            "check_vector - clone");
+    tester_assert(tst, int_vector_pop(&v) == 99 && int_vector_size(&v) == 99,
+            "check_vector - pop");
+    int_vector_clear(&v);
+    tester_assert(tst, !int_vector_size(&v), "check_vector - clear");
+    int items[100];
+    for (int i = 0; i < 100; i++)
+        items[i] = i;
+    bool ok = true;
+    for (int i = 0; i < 100 && ok; i += 7)
+        ok = int_vector_append(&v, items + i, i + 7 < 100 ? 7 : 100 - i);
+    tester_assert(tst,
+            ok && int_vector_size(&v) == 100 && int_vector_get(&v, 99) == 99 &&
+                    !memcmp(v.items, items, sizeof(items)) &&
+                    v.capacity == 128,
+            "check_vector - append");
+    int_vector_destroy(&copy);
+    int_vector_destroy(&v);
+}
+
+static void check_str_map(tester *tst)
+{
+    char keys[1000][8];
+    struct int_map m;
+    int_map_init(&m);
+    tester_assert(tst, !int_map_get(&m, "missing"), "check_str_map - empty");
+    for (int i = 0; i < 1000; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+        int_map_put(&m, keys[i], i);
+    }
+    int_map_put(&m, "k7", -7);
+    tester_assert(tst, int_map_size(&m) == 1000, "check_str_map - size");
+    bool found = true;
+    for (int i = 0; i < 1000; i++) {
+        int *value = int_map_get(&m, keys[i]);
+        found = found && value && *value == (i == 7 ? -7 : i);
+    }
+    tester_assert(tst, found, "check_str_map - get");
+    tester_assert(tst, !int_map_get(&m, "k1000"), "check_str_map - missing");
+    int count = 0;
+    STR_MAP_FOREACH(int_map, slot, &m)
+        count++;
+    tester_assert(tst, count == 1000, "check_str_map - foreach");
+    int_map_destroy(&m);
+}
+
+static void check_str_set(tester *tst)
+{
+    const char *expected[] = {"pear", "apple", "fig"};
+    struct str_set s;
+    str_set_init(&s);
+    tester_assert(tst, str_set_add(&s, "pear"), "check_str_set - add");
+    str_set_add(&s, "apple");
+    tester_assert(tst, !str_set_add(&s, "pear"), "check_str_set - duplicate");
+    str_set_add(&s, "fig");
+    tester_assert(tst, str_set_size(&s) == 3 && str_set_contains(&s, "fig") &&
+                    !str_set_contains(&s, "plum"),
+            "check_str_set - contains");
+    int i = 0;
+    bool ordered = true;
+    STR_SET_FOREACH(key, &s)
+        ordered = ordered && !strcmp(*key, expected[i++]);
+    tester_assert(tst, ordered && !strcmp(str_set_get(&s, 1), "apple"),
+            "check_str_set - order");
+    str_set_destroy(&s);
+
+    /* Past the threshold the membership is looked up in the index */
+    char keys[STR_SET_INDEX_THRESHOLD * 4][8];
+    str_set_init(&s);
+    for (int i = 0; i < STR_SET_INDEX_THRESHOLD * 4; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+        str_set_add(&s, keys[i]);
+    }
+    tester_assert(tst, s.index.capacity && !str_set_add(&s, "k3") &&
+                    str_set_contains(&s, "k40") && !str_set_contains(&s, "k"),
+            "check_str_set - indexed");
+    str_set_destroy(&s);
+}
+
+void test_containers(tester *tst)
+{
+    tester_new_group(tst, "test_containers");
+    check_vector(tst);
+    check_str_map(tst);
+    check_str_set(tst);
+}
@@ -30,6 +30,9 @@
  */
 
 #include "dparsertest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "dconsumer.h"
 #include "dparser.h"
 #include "logger.h"
@@ -44,28 +47,65 @@ const char *D1 =
         "\n"
         "workpace w1 -> /path/to/workspace {}\n";
 
+/* A declaration stream exercising every kind of declaration */
+const char *D2 =
+        "# Default projects\n"
+        "projects { alpha beta }\n"
+        "workspace w1 -> /path/to/w1 {\n"
+        "    gamma # custom project\n"
+        "    delta\r\n"
+        "}\n"
+        "workspace w2 -> /path/to/w2 {}\n";
+
+/* The declarations D2 is expected to produce */
+const char *D2_LOG = "P alpha\n"
+                     "P beta\n"
+                     "W w1 /path/to/w1\n"
+                     "WP w1 gamma\n"
+                     "WP w1 delta\n"
+                     "W w2 /path/to/w2\n";
+
+/*
+ * Records the declarations received, one per line.
+ */
 struct context {
+    char log[8192];
+    int len;
 };
 
-static void add_project(void *inst, const char *project)
+static void log_decl(struct context *ctx, const char *kind, const char *s1,
+        size_t len1, const char *s2, size_t len2)
 {
-    (void)inst;
-    (void)project;
+    int capacity = (int)sizeof(ctx->log) - ctx->len;
+    if (s2) {
+        ctx->len += snprintf(ctx->log + ctx->len, capacity, "%s %.*s %.*s\n",
+                kind, (int)len1, s1, (int)len2, s2);
+    } else {
+        ctx->len += snprintf(ctx->log + ctx->len, capacity, "%s %.*s\n", kind,
+                (int)len1, s1);
+    }
+    if (ctx->len >= (int)sizeof(ctx->log))
+        ctx->len = sizeof(ctx->log) - 1;
 }
 
-static void add_workspace(void *inst, const char *alias, const char *path)
+static void add_project(void *inst, const char *project, size_t len)
 {
-    (void)inst;
-    (void)alias;
-    (void)path;
+    if (inst)
+        log_decl(inst, "P", project, len, NULL, 0);
 }
 
-static void add_workspace_project(
-        void *inst, const char *alias, const char *project)
+static void add_workspace(void *inst, const char *alias, size_t alias_len,
+        const char *path, size_t path_len)
 {
-    (void)inst;
-    (void)alias;
-    (void)project;
+    if (inst)
+        log_decl(inst, "W", alias, alias_len, path, path_len);
+}
+
+static void add_workspace_project(void *inst, const char *alias,
+        size_t alias_len, const char *project, size_t project_len)
+{
+    if (inst)
+        log_decl(inst, "WP", alias, alias_len, project, project_len);
 }
 
 static void dcosumer_init(void *inst, struct dconsumer *dconsumer)
@@ -76,6 +116,29 @@ static void dcosumer_init(void *inst, struct dconsumer *dconsumer)
     dconsumer->add_workspace_project = add_workspace_project;
 }
 
+/*
+ * Parses the declaration stream in chunks of the specified size and returns
+ * the error message if any.
+ */
+static const char *parse(struct context *context, const char *def, size_t chunk)
+{
+    logger *logger = logger_create(-1, stdout);
+    struct dconsumer dconsumer;
+    context->len = 0;
+    context->log[0] = 0;
+    dcosumer_init(context, &dconsumer);
+    dparser *dparser = dpaser_new(logger, &dconsumer);
+    const char *err_msg = NULL;
+    size_t len = strlen(def);
+    for (size_t i = 0; i < len && !err_msg; i += chunk) {
+        err_msg = dparser_proc_buffer(
+                dparser, def + i, i + chunk < len ? chunk : len - i);
+    }
+    dparser_destroy(dparser);
+    logger_destroy(logger);
+    return err_msg;
+}
+
 static void check_parse_basic_def(tester *tst)
 {
     (void)tst;
@@ -83,6 +146,7 @@ static void check_parse_basic_def(tester *tst)
     struct dconsumer dconsumer;
     struct context context;
     dcosumer_init(&context, &dconsumer);
+    context.len = 0;
 
     dparser *dparser = dpaser_new(logger, &dconsumer);
 
@@ -94,6 +158,124 @@ static void check_parse_basic_def(tester *tst)
     logger_destroy(logger);
 }
 
+static void check_parse_buffer(tester *tst)
+{
+    struct context context;
+    tester_assert(tst,
+            !parse(&context, D2, strlen(D2)) && !strcmp(context.log, D2_LOG),
+            "check_parse_buffer");
+}
+
+/* The tokens cut by the chunk boundaries are carried over */
+static void check_parse_chunks(tester *tst)
+{
+    struct context context;
+    bool ok = true;
+    for (size_t chunk = 1; chunk < strlen(D2) && ok; chunk++)
+        ok = !parse(&context, D2, chunk) && !strcmp(context.log, D2_LOG);
+    tester_assert(tst, ok, "check_parse_chunks");
+}
+
+static void check_long_token(tester *tst)
+{
+    static char def[8192];
+    static char project[4000];
+    memset(project, 'x', sizeof(project) - 1);
+    snprintf(def, sizeof(def), "projects { %s }\n", project);
+    struct context context;
+    bool ok = true;
+    for (size_t chunk = 1000; chunk <= strlen(def) && ok; chunk += 1000) {
+        ok = !parse(&context, def, chunk) &&
+                context.len == (int)(strlen(project) + 3) &&
+                !strncmp(context.log + 2, project, strlen(project));
+    }
+    tester_assert(tst, ok, "check_long_token");
+}
+
+/*
+ * A '#' inside a token and the bytes outside of the printable ASCII range are
+ * dropped without splitting the token, the tab separates the tokens.
+ */
+static void check_char_classes(tester *tst)
+{
+    const char *def = "projects { a#b ab\x01" "cd e\x80\x7F" "f\tg #h\n}\n";
+    const char *expected = "P ab\nP abcd\nP ef\nP g\n";
+    struct context context;
+    bool ok = true;
+    for (size_t chunk = 1; chunk <= strlen(def) && ok; chunk++)
+        ok = !parse(&context, def, chunk) && !strcmp(context.log, expected);
+    tester_assert(tst, ok, "check_char_classes");
+}
+
+/*
+ * Parses D2 in chunks of the specified size with the workspace filter set,
+ * stopping at the first declaration of the workspace if requested.
+ */
+static void parse_filtered(struct context *context, const char *alias,
+        size_t chunk, bool stop)
+{
+    logger *logger = logger_create(-1, stdout);
+    struct dconsumer dconsumer;
+    context->len = 0;
+    context->log[0] = 0;
+    dcosumer_init(context, &dconsumer);
+    dparser *dparser = dpaser_new(logger, &dconsumer);
+    dparser_set_workspace_filter(dparser, alias);
+    const char *def = "projects { alpha }\n"
+                      "workspace w1 -> /w1 {\n"
+                      "    beta # not the end }\n"
+                      "    a#} gamma\n"
+                      "}\n"
+                      "workspace w2 -> /w2 { delta }\n"
+                      "workspace w1 -> /w1 { epsilon }\n";
+    size_t len = strlen(def);
+    for (size_t i = 0; i < len && !dparser_is_stopped(dparser); i += chunk) {
+        dparser_proc_buffer(
+                dparser, def + i, i + chunk < len ? chunk : len - i);
+        if (stop && strstr(context->log, "\nW "))
+            dparser_stop(dparser);
+    }
+    dparser_destroy(dparser);
+    logger_destroy(logger);
+}
+
+static void check_workspace_filter(tester *tst)
+{
+    struct context context;
+    bool ok = true;
+    for (size_t chunk = 1; chunk < 32 && ok; chunk++) {
+        parse_filtered(&context, "w2", chunk, false);
+        ok = !strcmp(context.log, "P alpha\nW w2 /w2\nWP w2 delta\n");
+    }
+    tester_assert(tst, ok, "check_workspace_filter");
+    parse_filtered(&context, "w1", 1000, false);
+    tester_assert(tst,
+            !strcmp(context.log, "P alpha\n"
+                                 "W w1 /w1\n"
+                                 "WP w1 beta\n"
+                                 "WP w1 a\n"
+                                 "W w1 /w1\n"
+                                 "WP w1 epsilon\n"),
+            "check_workspace_filter - comments");
+}
+
+static void check_stop(tester *tst)
+{
+    struct context context;
+    parse_filtered(&context, "w2", 1, true);
+    tester_assert(tst, !strcmp(context.log, "P alpha\nW w2 /w2\n"),
+            "check_stop");
+}
+
+static void check_parse_errors(tester *tst)
+{
+    struct context context;
+    tester_assert(tst, parse(&context, "workspace w1 /path {}\n", 4),
+            "check_parse_errors - pointer");
+    tester_assert(tst, parse(&context, "other {}\n", 4),
+            "check_parse_errors - block");
+}
+
 static void check_construction(tester *tst)
 {
     (void)tst; /* parameter used in tester_assert macro */
@@ -113,4 +295,72 @@ void test_dparser(tester *tst)
     tester_new_group(tst, "test_dparser");
     check_construction(tst);
     check_parse_basic_def(tst);
+    check_parse_buffer(tst);
+    check_parse_chunks(tst);
+    check_long_token(tst);
+    check_char_classes(tst);
+    check_parse_errors(tst);
+    check_workspace_filter(tst);
+    check_stop(tst);
+}
+
+/* Approximate size of the generated definition stream */
+#define BENCH_DEF_SIZE (4 * 1024 * 1024)
+
+struct parser_bench {
+    dparser *parser;
+    char *def;
+};
+
+/* The size of the chunks fed to dparser_proc_buffer() */
+#define BENCH_CHUNK_SIZE 4096
+
+static void bench_proc_char(void *inst, int i)
+{
+    struct parser_bench *b = inst;
+    dparser_proc_char(b->parser, b->def[i]);
+}
+
+static void bench_proc_buffer(void *inst, int i)
+{
+    struct parser_bench *b = inst;
+    dparser_proc_buffer(
+            b->parser, b->def + i * BENCH_CHUNK_SIZE, BENCH_CHUNK_SIZE);
+}
+
+/*
+ * Generates a multi-megabyte definition stream made of a large projects
+ * block followed by workspaces with their own projects.
+ */
+static int generate_def(char *dst, int capacity)
+{
+    int len = snprintf(dst, capacity, "# Generated\nprojects {\n");
+    for (int i = 0; len < capacity / 2; i++)
+        len += snprintf(dst + len, capacity - len, "    project%06d\n", i);
+    len += snprintf(dst + len, capacity - len, "}\n");
+    for (int i = 0; len < capacity - 256; i++) {
+        len += snprintf(dst + len, capacity - len,
+                "workspace w%d -> /path/to/workspace%d {\n"
+                "    extra%d # custom project\n"
+                "}\n",
+                i, i, i);
+    }
+    return len;
+}
+
+void bench_dparser(tester *tst)
+{
+    logger *logger = logger_create(-1, stdout);
+    struct dconsumer dconsumer;
+    struct parser_bench b;
+    dcosumer_init(NULL, &dconsumer);
+    b.parser = dpaser_new(logger, &dconsumer);
+    b.def = malloc(BENCH_DEF_SIZE);
+    int len = generate_def(b.def, BENCH_DEF_SIZE);
+    tester_bench(tst, "dparser_proc_char/4MiB", bench_proc_char, &b, len);
+    tester_bench(tst, "dparser_proc_buffer/4KiB", bench_proc_buffer, &b,
+            len / BENCH_CHUNK_SIZE);
+    free(b.def);
+    dparser_destroy(b.parser);
+    logger_destroy(logger);
 }
@@ -35,5 +35,6 @@
 #include "tester.h"
 
 void test_dparser(tester *);
+void bench_dparser(tester *);
 
 #endif /* DPARSERTEST_H_ */
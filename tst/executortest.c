@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * executortest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "executortest.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "config.h"
+#include "executor.h"
+#include "logger.h"
+#include "plan.h"
+#include "proc.h"
+#include "universe.h"
+
+#define TEST_DIR "/tmp/octo_executortest"
+#define DEF_FILE "/tmp/octo_executortest_def"
+#define OUTPUT_FILE "/tmp/octo_executortest_out"
+
+struct results {
+    int count;
+    int failures;
+    /* The jobs in the order they were done */
+    char order[8];
+};
+
+static void handle_error(void *inst, int err_code, const char *err_msg)
+{
+    (void)err_code; /* unused parameter */
+    (void)err_msg; /* unused parameter */
+    tester_assert(inst, false, "test_executor - error");
+}
+
+static void handle_result(void *inst, int job, const struct proc_result *r)
+{
+    struct results *results = inst;
+    if (results->count < (int)sizeof(results->order) - 1)
+        results->order[results->count] = r->project[0];
+    results->count++;
+    results->failures += r->exit_code != 0 || job != r->project[0] - 'a';
+}
+
+/*
+ * Runs the command on the projects a, b and c with the output of this
+ * process going to the output file.
+ */
+static bool run(tester *tst, int argc, char *argv[], struct results *results,
+        char *output, int len)
+{
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs("workspace w -> " TEST_DIR " { a b c }\n", file);
+    fclose(file);
+    logger *log = logger_create(-1, stdout);
+    universe *u = universe_new(log, DEF_FILE, tst, handle_error);
+    config *cfg = config_new();
+    config_parse_cmd_line(cfg, argc, argv);
+    proc *p = proc_new(log, cfg);
+    proc_parse_cmd_line(p, argc, argv);
+    plan *plan = plan_new(u, NULL);
+
+    struct executor_options options = {2, true, false};
+    executor *e = executor_new(plan, &options);
+    memset(results, 0, sizeof(*results));
+    fflush(stdout);
+    int stdout_fd = dup(STDOUT_FILENO);
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    bool ok = executor_run(e, p, results, handle_result);
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(stdout_fd);
+    ssize_t n = pread(fd, output, len - 1, 0);
+    output[n < 0 ? 0 : n] = 0;
+    close(fd);
+
+    executor_destroy(e);
+    plan_destroy(plan);
+    proc_destroy(p);
+    config_destroy(cfg);
+    universe_destroy(u);
+    logger_destroy(log);
+    remove(OUTPUT_FILE);
+    remove(DEF_FILE);
+    return ok;
+}
+
+static void check_ordered_output(tester *tst)
+{
+    mkdir(TEST_DIR, 0755);
+    mkdir(TEST_DIR "/a", 0755);
+    mkdir(TEST_DIR "/b", 0755);
+    mkdir(TEST_DIR "/c", 0755);
+    /* The first job takes the longest but its output still comes first */
+    char *argv[] = {"octo", "-v", "exec",
+            "[ ${PWD##*/} = a ] && sleep 0.2; echo ${PWD##*/}"};
+    struct results results;
+    char output[256];
+    bool ok = run(tst, 4, argv, &results, output, sizeof(output));
+    tester_assert(tst, ok && results.count == 3 && !results.failures,
+            "check_ordered_output");
+    tester_assert(tst, results.order[2] == 'a',
+            "check_ordered_output - concurrent");
+    tester_assert(tst,
+            !strcmp(output, "Workspace " TEST_DIR " (name: w)\na\nb\nc\n"),
+            "check_ordered_output - output");
+}
+
+static void check_aborted(tester *tst)
+{
+    /* An invalid repository aborts every job */
+    char *argv[] = {"octo", "clone", "bad;"};
+    struct results results;
+    char output[512];
+    bool ok = run(tst, 3, argv, &results, output, sizeof(output));
+    tester_assert(tst, !ok && !results.count, "check_aborted");
+    tester_assert(tst, strstr(output, "Error: Invalid repository URL\n") != NULL,
+            "check_aborted - output");
+    rmdir(TEST_DIR "/a");
+    rmdir(TEST_DIR "/b");
+    rmdir(TEST_DIR "/c");
+    rmdir(TEST_DIR);
+}
+
+void test_executor(tester *tst)
+{
+    tester_new_group(tst, "test_executor");
+    check_ordered_output(tst);
+    check_aborted(tst);
+}
@@ -229,6 +229,39 @@ static void check_clear_and_traverse(tester *tst)
     hash_map_destroy(map);
 }
 
+static void check_rehash(tester *tst)
+{
+    char key[16];
+    HHASHMAP map = hash_map_create_ex(2, 0.75f);
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        hash_map_put(map, key, (void *)(long)(i + 1));
+    }
+    tester_assert(tst, hash_map_get_size(map) == 10000, "check_rehash - size");
+    bool found = true;
+    for (int i = 0; i < 10000; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        found = found && hash_map_get(map, key) == (void *)(long)(i + 1);
+    }
+    tester_assert(tst, found, "check_rehash - get");
+    for (int i = 0; i < 10000; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        hash_map_remove(map, key);
+    }
+    int traverse_count = 0;
+    hash_map_traverse(map, &traverse_count, traverse_callback);
+    tester_assert(tst, traverse_count == 5000 && hash_map_get_size(map) == 5000,
+            "check_rehash - remove");
+    hash_map_destroy(map);
+
+    /* Invalid parameters fall back to the defaults */
+    map = hash_map_create_ex(0, 0);
+    hash_map_put(map, "key", "value");
+    tester_assert(tst, !strcmp(hash_map_get(map, "key"), "value"),
+            "check_rehash - defaults");
+    hash_map_destroy(map);
+}
+
 void test_hash_map(tester *tst)
 {
     tester_new_group(tst, "test_hash_map");
@@ -238,4 +271,67 @@ void test_hash_map(tester *tst)
     check_remove_return_value(tst);
     check_hash_collisions(tst);
     check_clear_and_traverse(tst);
-}
\ No newline at end of file
+    check_rehash(tst);
+}
+/* Number of keys in the hash map benchmarks */
+static const int BENCH_SIZES[] = {10000, 100000, 1000000};
+/* Larger maps are skipped once a fill is projected to take longer */
+static const double BENCH_MAX_FILL_NS = 30e9;
+
+struct map_bench {
+    HHASHMAP map;
+    char **keys;
+    int size;
+};
+
+static void bench_put(void *inst, int i)
+{
+    struct map_bench *b = inst;
+    if (!i)
+        hash_map_clear(b->map);
+    hash_map_put(b->map, b->keys[i], b->keys[i]);
+}
+
+static void bench_get(void *inst, int i)
+{
+    struct map_bench *b = inst;
+    /* Stride through the keys to defeat the insertion order locality */
+    hash_map_get(b->map, b->keys[(int)(i * 7919LL % b->size)]);
+}
+
+void bench_hash_map(tester *tst)
+{
+    char name[64];
+    double fill_ns = 0;
+    for (size_t n = 0; n < sizeof(BENCH_SIZES) / sizeof(int); n++) {
+        struct map_bench b;
+        b.size = BENCH_SIZES[n];
+        /*
+         * Project the cost of the next fill assuming the put cost grows
+         * linearly with the map size (the worst case of long chains).
+         */
+        if (n && fill_ns * BENCH_SIZES[n] / BENCH_SIZES[n - 1] *
+                                BENCH_SIZES[n] / BENCH_SIZES[n - 1] >
+                        BENCH_MAX_FILL_NS) {
+            snprintf(name, sizeof(name), "hash_map_put/%d", b.size);
+            tester_bench_skip(tst, name);
+            snprintf(name, sizeof(name), "hash_map_get/%d", b.size);
+            tester_bench_skip(tst, name);
+            continue;
+        }
+        b.map = hash_map_create();
+        b.keys = malloc(sizeof(char *) * b.size);
+        for (int i = 0; i < b.size; i++) {
+            b.keys[i] = malloc(16);
+            snprintf(b.keys[i], 16, "key%07d", i);
+        }
+        snprintf(name, sizeof(name), "hash_map_put/%d", b.size);
+        fill_ns = tester_bench(tst, name, bench_put, &b, b.size) * b.size;
+        snprintf(name, sizeof(name), "hash_map_get/%d", b.size);
+        tester_bench(tst, name, bench_get, &b, b.size);
+        hash_map_destroy(b.map);
+        for (int i = 0; i < b.size; i++)
+            free(b.keys[i]);
+        free(b.keys);
+    }
+}
@@ -35,5 +35,6 @@
 #include "tester.h"
 
 void test_hash_map(tester *tst);
+void bench_hash_map(tester *tst);
 
 #endif /* HASHMAPTEST_H_ */
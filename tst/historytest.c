@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "historytest.h"
+#include <stdio.h>
+#include <string.h>
+#include "history.h"
+
+#define HISTORY_FILE "/tmp/octo_historytest"
+
+struct read_state {
+    int count;
+    struct history_entry last;
+    char project[64];
+};
+
+static void count_entry(void *inst, const struct history_entry *e)
+{
+    struct read_state *state = inst;
+    state->count++;
+    state->last = *e;
+    snprintf(state->project, sizeof(state->project), "%s", e->project);
+}
+
+static void add_result(history *h, const char *project, int exit_code)
+{
+    struct proc_result r;
+    memset(&r, 0, sizeof(r));
+    r.action = PULL;
+    r.project = project;
+    r.exit_code = exit_code;
+    r.duration_ns = 42;
+    r.bytes = 1024;
+    history_add(h, "w1", &r);
+}
+
+static void check_round_trip(tester *tst)
+{
+    remove(HISTORY_FILE);
+    history *h = history_new(HISTORY_FILE);
+    tester_assert(tst, h != NULL, "check_round_trip - new");
+    add_result(h, "a", 0);
+    history_destroy(h);
+
+    /* Appends to the existing file */
+    h = history_new(HISTORY_FILE);
+    add_result(h, "bb", 1);
+    history_destroy(h);
+
+    struct read_state state;
+    state.count = 0;
+    tester_assert(tst, history_read(HISTORY_FILE, &state, count_entry),
+            "check_round_trip - read");
+    tester_assert(tst, state.count == 2, "check_round_trip - count");
+    tester_assert(tst,
+            state.last.action == PULL && state.last.exit_code == 1 &&
+                    state.last.duration_ns == 42 && state.last.bytes == 1024 &&
+                    !strcmp(state.project, "bb"),
+            "check_round_trip - entry");
+}
+
+static void check_truncated(tester *tst)
+{
+    /* Simulate a record cut short by a crash */
+    FILE *file = fopen(HISTORY_FILE, "ab");
+    fwrite("\1\2\3", 1, 3, file);
+    fclose(file);
+    struct read_state state;
+    state.count = 0;
+    tester_assert(tst, history_read(HISTORY_FILE, &state, count_entry) &&
+                    state.count == 2,
+            "check_truncated");
+    remove(HISTORY_FILE);
+}
+
+static void check_invalid(tester *tst)
+{
+    FILE *file = fopen(HISTORY_FILE, "w");
+    fputs("projects { a }\n", file);
+    fclose(file);
+    struct read_state state;
+    state.count = 0;
+    tester_assert(tst, !history_read(HISTORY_FILE, &state, count_entry),
+            "check_invalid - magic");
+    remove(HISTORY_FILE);
+    tester_assert(tst, !history_read(HISTORY_FILE, &state, count_entry),
+            "check_invalid - missing");
+}
+
+void test_history(tester *tst)
+{
+    tester_new_group(tst, "test_history");
+    check_round_trip(tst);
+    check_truncated(tst);
+    check_invalid(tst);
+}
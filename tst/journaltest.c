@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * journaltest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "journaltest.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "journal.h"
+
+#define JOURNAL_DIR "/tmp/octo_journaltest/journal"
+#define SIGNATURE "/tmp/def\tw\t\tpull"
+
+static void add_result(journal *j, const char *project, int exit_code)
+{
+    struct proc_result r;
+    memset(&r, 0, sizeof(r));
+    r.action = PULL;
+    r.project = project;
+    r.exit_code = exit_code;
+    journal_add(j, "w", &r);
+}
+
+static void check_resume(tester *tst)
+{
+    journal *j = journal_new(JOURNAL_DIR, SIGNATURE, false);
+    tester_assert(tst, j && !access(journal_get_file_name(j), F_OK),
+            "check_resume - new");
+    add_result(j, "a", 0);
+    add_result(j, "b", 1);
+    journal_destroy(j);
+
+    /* The run is resumed past the projects done successfully */
+    j = journal_new(JOURNAL_DIR, SIGNATURE, true);
+    tester_assert(tst,
+            journal_is_done(j, "w", "a") && !journal_is_done(j, "w", "b") &&
+                    !journal_is_done(j, "w", "c") &&
+                    !journal_is_done(j, "x", "a"),
+            "check_resume");
+    add_result(j, "b", 0);
+    journal_destroy(j);
+    j = journal_new(JOURNAL_DIR, SIGNATURE, true);
+    tester_assert(tst,
+            journal_is_done(j, "w", "a") && journal_is_done(j, "w", "b"),
+            "check_resume - again");
+    journal_destroy(j);
+
+    /* The runs with other signatures have journals of their own */
+    j = journal_new(JOURNAL_DIR, SIGNATURE "\t-p", true);
+    tester_assert(tst, !journal_is_done(j, "w", "a"),
+            "check_resume - other signature");
+    journal_discard(j);
+    journal_destroy(j);
+
+    /* A run that is not resumed starts over */
+    j = journal_new(JOURNAL_DIR, SIGNATURE, false);
+    journal_destroy(j);
+    j = journal_new(JOURNAL_DIR, SIGNATURE, true);
+    tester_assert(tst, !journal_is_done(j, "w", "a"),
+            "check_resume - start over");
+    journal_discard(j);
+    tester_assert(tst, access(journal_get_file_name(j), F_OK),
+            "check_resume - discard");
+    journal_destroy(j);
+    rmdir(JOURNAL_DIR);
+    rmdir("/tmp/octo_journaltest");
+}
+
+void test_journal(tester *tst)
+{
+    tester_new_group(tst, "test_journal");
+    check_resume(tst);
+}
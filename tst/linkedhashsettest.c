@@ -29,6 +29,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 #include "linkedhashsettest.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "linkedhashset.h"
 #include "linkedlist.h"
@@ -78,10 +80,88 @@ static void check_traverse(tester *tst)
     linked_hash_set_destroy(set);
 }
 
+static void check_foreach(tester *tst)
+{
+    const char *expected[] = {"apple", "banana", "pear"};
+    linked_hash_set *set = linked_hash_set_new();
+    linked_hash_set_add(set, "apple");
+    linked_hash_set_add(set, "banana");
+    linked_hash_set_add(set, "apple");
+    linked_hash_set_add(set, "pear");
+    int i = 0;
+    bool ordered = true;
+    LINKED_HASH_SET_FOREACH(item, set)
+        ordered = ordered && i < 3 && !strcmp(expected[i++], *item);
+    tester_assert(tst, ordered && i == 3, "check_foreach");
+    linked_hash_set_destroy(set);
+}
+
+static void check_large_set(tester *tst)
+{
+    /* Crosses the threshold the set starts being hashed at */
+    static char keys[100][8];
+    linked_hash_set *set = linked_hash_set_new();
+    for (int i = 0; i < 100; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "p%d", i);
+        linked_hash_set_add(set, keys[i]);
+    }
+    char duplicate[8];
+    for (int i = 0; i < 100; i++) {
+        snprintf(duplicate, sizeof(duplicate), "p%d", i);
+        linked_hash_set_add(set, duplicate);
+    }
+    tester_assert(
+            tst, linked_hash_set_get_size(set) == 100, "check_large_set - size");
+    int i = 0;
+    bool borrowed = true;
+    LINKED_HASH_SET_FOREACH(item, set)
+        borrowed = borrowed && *item == keys[i++];
+    tester_assert(tst, borrowed, "check_large_set - borrowed");
+    linked_hash_set_destroy(set);
+}
+
 void test_linked_hash_set(tester *tst)
 {
     tester_new_group(tst, "test_git");
     check_construction(tst);
     check_traverse(tst);
     check_add(tst);
+    check_foreach(tst);
+    check_large_set(tst);
+}
+
+struct set_bench {
+    linked_hash_set *set;
+    char **keys;
+};
+
+static void bench_add(void *inst, int i)
+{
+    struct set_bench *b = inst;
+    if (!i) {
+        linked_hash_set_destroy(b->set);
+        b->set = linked_hash_set_new();
+    }
+    linked_hash_set_add(b->set, b->keys[i]);
+}
+
+void bench_linked_hash_set(tester *tst)
+{
+    static const int sizes[] = {8, 64, 1024, 10000};
+    char name[64];
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(int); n++) {
+        struct set_bench b;
+        b.set = linked_hash_set_new();
+        b.keys = malloc(sizeof(char *) * sizes[n]);
+        for (int i = 0; i < sizes[n]; i++) {
+            b.keys[i] = malloc(24);
+            snprintf(b.keys[i], 24, "project%05d", i);
+        }
+        snprintf(name, sizeof(name), "linked_hash_set_add/%d", sizes[n]);
+        tester_bench(tst, name, bench_add, &b, sizes[n]);
+        linked_hash_set_destroy(b.set);
+        for (int i = 0; i < sizes[n]; i++)
+            free(b.keys[i]);
+        free(b.keys);
+    }
 }
@@ -35,5 +35,6 @@
 #include "tester.h"
 
 void test_linked_hash_set(tester *tst);
+void bench_linked_hash_set(tester *tst);
 
 #endif /* LINKEDHASHSETTEST_H_ */
@@ -122,5 +122,42 @@ void test_linked_list()
     linked_list_clear(listCopy);
     assert(linked_list_get_size(listCopy) == 0);
 
+    // The last entry must still be reachable after removing the first one
+    linked_list_add(listCopy, "apples");
+    linked_list_add(listCopy, "mangoes");
+    linked_list_add(listCopy, "pears");
+    linked_list_remove_first(listCopy);
+    linked_list_add(listCopy, "plums");
+    assert(!strcmp(linked_list_remove_last(listCopy), "plums"));
+    assert(!strcmp(linked_list_remove_last(listCopy), "pears"));
+    linked_list_clear(listCopy);
+
+    // The removed entries are recycled rather than freed
+    long allocs = tester_alloc_count();
+    for (i = 0; i < 3; i++)
+        linked_list_add(listCopy, (char *)tokens[i]);
+    while (linked_list_remove_first(listCopy))
+        ;
+    assert(allocs < 0 || tester_alloc_count() == allocs);
+
     linked_list_destroy(listCopy);
 }
+
+static void bench_get(void *inst, int i)
+{
+    linked_list_get(inst, i);
+}
+
+void bench_linked_list(tester *tst)
+{
+    static const int sizes[] = {100, 1000, 10000};
+    char name[64];
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(int); n++) {
+        HLINKEDLIST list = linked_list_create();
+        for (int i = 0; i < sizes[n]; i++)
+            linked_list_add(list, (void *)"value");
+        snprintf(name, sizeof(name), "linked_list_get/%d", sizes[n]);
+        tester_bench(tst, name, bench_get, list, sizes[n]);
+        linked_list_destroy(list);
+    }
+}
@@ -32,6 +32,9 @@
 #ifndef LINKEDLISTTEST_H_
 #define LINKEDLISTTEST_H_
 
+#include "tester.h"
+
 void test_linked_list();
+void bench_linked_list(tester *);
 
 #endif /* LINKEDLISTTEST_H_ */
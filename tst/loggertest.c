@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * loggertest.c
+ */
+
+#define _GNU_SOURCE
+
+#include "loggertest.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "logger.h"
+
+#define OUTPUT_FILE "/tmp/octo_loggertest"
+/* Threads logging at once and the entries logged by each of them */
+#define THREADS 4
+#define THREAD_ENTRIES 5000
+/* Entries logged per benchmark sample */
+#define BENCH_ENTRIES 10000
+
+/* Reads back what was written to the output file */
+static const char *read_output(FILE *file)
+{
+    static char content[4096];
+    fflush(file);
+    size_t n = pread(fileno(file), content, sizeof(content) - 1, 0);
+    content[n == (size_t)-1 ? 0 : n] = '\0';
+    return content;
+}
+
+/* Checks the entry follows the timestamp, e.g. 01/02/2026 10:20:30 */
+static bool is_entry(const char *s, const char *entry)
+{
+    return strlen(s) > 20 && s[2] == '/' && s[5] == '/' && s[13] == ':' &&
+            s[16] == ':' && s[19] == ' ' && !strcmp(s + 20, entry);
+}
+
+static void check_levels(tester *tst)
+{
+    FILE *file = fopen(OUTPUT_FILE, "w+");
+    logger *log = logger_create(-1, file);
+    tester_assert(tst, logger_get_level(log) == LOGLEVEL_DEFAULT,
+            "check_levels - default");
+    logger_set_level(log, LOGLEVEL_WARN);
+    logger_info(log, "skipped\n");
+    logger_warn(log, "kept %d\n", 1);
+    logger_flush(log);
+    tester_assert(tst, is_entry(read_output(file), "[WARNING] kept 1\n"),
+            "check_levels");
+    logger_set_level(log, LOGLEVEL_DEBUG);
+    DEBUG_LOG(log, "debug\n");
+    logger_destroy(log);
+    tester_assert(tst, strstr(read_output(file), "[DEBUG] debug\n") != NULL,
+            "check_levels - debug");
+    tester_assert(tst,
+            logger_parse_level("warn") == LOGLEVEL_WARN &&
+                    logger_parse_level("debug") == LOGLEVEL_DEBUG &&
+                    logger_parse_level("trace") == -1,
+            "check_levels - parse");
+    fclose(file);
+    remove(OUTPUT_FILE);
+}
+
+static void check_session(tester *tst)
+{
+    FILE *file = fopen(OUTPUT_FILE, "w+");
+    tester_assert(tst, !logger_create(-2, file), "check_session - invalid");
+    logger *log = logger_create(3, file);
+    logger_info(log, "started\n");
+    logger_destroy(log);
+    tester_assert(tst, is_entry(read_output(file), "S3[INFO] started\n"),
+            "check_session");
+    fclose(file);
+    remove(OUTPUT_FILE);
+}
+
+struct thread_args {
+    logger *log;
+    int id;
+};
+
+static void *log_entries(void *arg)
+{
+    struct thread_args *args = arg;
+    for (int i = 0; i < THREAD_ENTRIES; i++)
+        logger_info(args->log, "thread %d entry %d\n", args->id, i);
+    return NULL;
+}
+
+/*
+ * Checks the entries of several threads are written out whole and in the
+ * order each of the threads logged them.
+ */
+static void check_threads(tester *tst)
+{
+    FILE *file = fopen(OUTPUT_FILE, "w+");
+    logger *log = logger_create(-1, file);
+    pthread_t threads[THREADS];
+    struct thread_args args[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        args[i].log = log;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, log_entries, &args[i]);
+    }
+    for (int i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+    logger_destroy(log);
+
+    int next[THREADS] = {0};
+    bool ordered = true;
+    int entries = 0;
+    char line[128];
+    rewind(file);
+    while (fgets(line, sizeof(line), file)) {
+        int id, n;
+        if (sscanf(line + 20, "[INFO] thread %d entry %d", &id, &n) != 2 ||
+                id < 0 || id >= THREADS || n != next[id]++)
+            ordered = false;
+        entries++;
+    }
+    tester_assert(tst, ordered && entries == THREADS * THREAD_ENTRIES,
+            "check_threads");
+    fclose(file);
+    remove(OUTPUT_FILE);
+}
+
+/* Checks a forked child writes its entries out itself */
+static void check_fork(tester *tst)
+{
+    FILE *file = fopen(OUTPUT_FILE, "w+");
+    logger *log = logger_create(-1, file);
+    pid_t pid = fork();
+    if (!pid) {
+        logger_info(log, "child\n");
+        logger_flush(log);
+        _exit(EXIT_SUCCESS);
+    }
+    waitpid(pid, NULL, 0);
+    tester_assert(tst, is_entry(read_output(file), "[INFO] child\n"),
+            "check_fork");
+    logger_destroy(log);
+    fclose(file);
+    remove(OUTPUT_FILE);
+}
+
+static void *log_child_entry(void *arg)
+{
+    logger_info(arg, "child thread\n");
+    return NULL;
+}
+
+struct pipe_output {
+    int fd;
+    size_t len;
+    char text[64 * 1024];
+};
+
+static void *read_pipe(void *arg)
+{
+    struct pipe_output *out = arg;
+    ssize_t n;
+    while ((n = read(out->fd, out->text + out->len,
+                    sizeof(out->text) - 1 - out->len)) > 0)
+        out->len += n;
+    out->text[out->len] = 0;
+    return NULL;
+}
+
+/*
+ * Checks a forked child can log from a new thread while the writer of the
+ * parent is stuck writing to a full pipe.
+ */
+static void check_fork_busy_writer(tester *tst)
+{
+    int fds[2];
+    if (pipe(fds))
+        return;
+#ifdef F_SETPIPE_SZ
+    fcntl(fds[1], F_SETPIPE_SZ, 4096);
+#endif
+    FILE *file = fdopen(fds[1], "w");
+    logger *log = logger_create(-1, file);
+    /*
+     * Queue up more than the pipe holds (but less than the buffer of the
+     * thread) and let the writer block on it
+     */
+    char filler[512];
+    memset(filler, 'x', sizeof(filler) - 1);
+    filler[sizeof(filler) - 1] = 0;
+    for (int i = 0; i < 32; i++)
+        logger_info(log, "%s\n", filler);
+    struct timespec pause = {0, 100 * 1000 * 1000L};
+    nanosleep(&pause, NULL);
+
+    pid_t pid = fork();
+    if (!pid) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, log_child_entry, log);
+        pthread_join(thread, NULL);
+        logger_flush(log);
+        _exit(EXIT_SUCCESS);
+    }
+    /* Keep reading the pipe in the background till it is closed */
+    pthread_t reader;
+    struct pipe_output out;
+    out.fd = fds[0];
+    out.len = 0;
+    pthread_create(&reader, NULL, read_pipe, &out);
+    int status = -1;
+    bool done = false;
+    for (int i = 0; i < 50 && !done; i++) {
+        done = waitpid(pid, &status, WNOHANG) == pid;
+        if (!done)
+            nanosleep(&pause, NULL);
+    }
+    if (!done) {
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+    }
+    logger_destroy(log);
+    fclose(file);
+    pthread_join(reader, NULL);
+    close(fds[0]);
+    tester_assert(tst,
+            done && !status && strstr(out.text, "[INFO] child thread\n"),
+            "check_fork_busy_writer");
+}
+
+static void bench_log(void *inst, int i)
+{
+    logger_debug(inst, "bench: entry %d of %s\n", i, "the benchmark");
+}
+
+void bench_logger(tester *tst)
+{
+    FILE *file = fopen("/dev/null", "w");
+    logger *log = logger_create(-1, file);
+    logger_set_level(log, LOGLEVEL_DEBUG);
+    tester_bench(tst, "logger/debug", bench_log, log, BENCH_ENTRIES);
+    logger_set_level(log, LOGLEVEL_INFO);
+    tester_bench(tst, "logger/filtered", bench_log, log, BENCH_ENTRIES);
+    logger_destroy(log);
+    fclose(file);
+}
+
+void test_logger(tester *tst)
+{
+    tester_new_group(tst, "test_logger");
+    check_levels(tst);
+    check_session(tst);
+    check_threads(tst);
+    check_fork(tst);
+    check_fork_busy_writer(tst);
+}
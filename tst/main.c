@@ -31,22 +31,68 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "cmdline.h"
 #include "cmdlinetest.h"
 #include "configtest.h"
+#include "containerstest.h"
 #include "dparsertest.h"
+#include "executortest.h"
 #include "hashmaptest.h"
+#include "historytest.h"
+#include "journaltest.h"
 #include "linkedhashsettest.h"
 #include "linkedlisttest.h"
+#include "loggertest.h"
+#include "metricstest.h"
+#include "ndjsontest.h"
+#include "plantest.h"
+#include "progresstest.h"
 #include "proctest.h"
+#include "statstest.h"
+#include "strpooltest.h"
+#include "summarytest.h"
 #include "tester.h"
+#include "ucachetest.h"
 #include "universetest.h"
+#include "utilstest.h"
+#include "wheretest.h"
 #include "workspacetest.h"
+#include "xsystemtest.h"
+
+#define DEFAULT_BENCH_FILE "bench_output.txt"
+
+/*
+ * Runs the benchmarks and writes their results to the specified file.
+ */
+static int bench(tester *tst, const char *file_name)
+{
+    FILE *file = fopen(file_name, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", file_name);
+        return EXIT_FAILURE;
+    }
+    tester_set_bench_file(tst, file);
+    bench_hash_map(tst);
+    bench_linked_list(tst);
+    bench_linked_hash_set(tst);
+    bench_dparser(tst);
+    bench_xsystem(tst);
+    bench_logger(tst);
+    fclose(file);
+    tester_set_bench_file(tst, NULL);
+    return EXIT_SUCCESS;
+}
 
 int main(int argn, char *args[])
 {
-    (void)argn;
-    (void)args;
     tester *tst = tester_create(true);
+    if (argn > 1 && equal_opts(args[1], "--bench")) {
+        char *file_name = strchr(args[1], '=');
+        int result = bench(tst, file_name ? file_name + 1 : DEFAULT_BENCH_FILE);
+        tester_destroy(tst);
+        return result;
+    }
     test_workspace(tst);
     test_dparser(tst);
     test_proc(tst);
@@ -56,5 +102,21 @@ int main(int argn, char *args[])
     test_linked_hash_set(tst);
     test_cmdline(tst);
     test_config(tst);
+    test_xsystem(tst);
+    test_metrics(tst);
+    test_history(tst);
+    test_stats(tst);
+    test_containers(tst);
+    test_str_pool(tst);
+    test_plan(tst);
+    test_ucache(tst);
+    test_utils(tst);
+    test_where(tst);
+    test_ndjson(tst);
+    test_progress(tst);
+    test_executor(tst);
+    test_logger(tst);
+    test_summary(tst);
+    test_journal(tst);
     tester_destroy(tst);
 }
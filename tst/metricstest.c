@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "metricstest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metrics.h"
+
+#define METRICS_FILE "/tmp/octo_metricstest.prom"
+
+static void add_result(metrics *m, const char *workspace, const char *project,
+        int exit_code, int dirty)
+{
+    struct proc_result r;
+    r.action = PULL;
+    r.path = "/tmp";
+    r.project = project;
+    r.exit_code = exit_code;
+    r.dirty = dirty;
+    r.ahead = 1;
+    r.behind = -1;
+    r.duration_ns = 1500000000LL;
+    r.bytes = 0;
+    metrics_add(m, workspace, &r);
+}
+
+/* Reads the whole content of the metrics file */
+static char *read_metrics_file()
+{
+    static char content[4096];
+    FILE *file = fopen(METRICS_FILE, "r");
+    if (!file)
+        return NULL;
+    size_t n = fread(content, 1, sizeof(content) - 1, file);
+    content[n] = '\0';
+    fclose(file);
+    return content;
+}
+
+static void check_write(tester *tst)
+{
+    metrics *m = metrics_new();
+    add_result(m, "w1", "a", 0, 1);
+    add_result(m, "w1", "b\"c", 1, 0);
+    add_result(m, "w2", "d", 0, -1);
+    tester_assert(tst, metrics_write(m, METRICS_FILE), "check_write");
+    char *content = read_metrics_file();
+    tester_assert(tst, content != NULL, "check_write - read");
+    if (!content) {
+        metrics_destroy(m);
+        return;
+    }
+    tester_assert(tst,
+            strstr(content, "octo_project_duration_seconds{workspace=\"w1\","
+                            "project=\"a\",action=\"pull\"} 1.500000\n") !=
+                    NULL,
+            "check_write - duration");
+    tester_assert(tst,
+            strstr(content, "octo_project_exit_code{workspace=\"w1\","
+                            "project=\"b\\\"c\",action=\"pull\"} 1\n") !=
+                    NULL,
+            "check_write - escaping");
+    tester_assert(tst,
+            strstr(content, "octo_project_dirty{workspace=\"w2\"") == NULL,
+            "check_write - unknown value");
+    tester_assert(tst,
+            strstr(content, "octo_project_behind_commits{") == NULL,
+            "check_write - unknown upstream");
+    tester_assert(tst,
+            strstr(content, "octo_workspace_projects{workspace=\"w1\","
+                            "action=\"pull\"} 2\n") != NULL,
+            "check_write - workspace projects");
+    tester_assert(tst,
+            strstr(content, "octo_workspace_failures{workspace=\"w1\","
+                            "action=\"pull\"} 1\n") != NULL,
+            "check_write - workspace failures");
+    size_t len = strlen(content);
+    tester_assert(tst, len > 6 && !strcmp(content + len - 6, "# EOF\n"),
+            "check_write - terminator");
+    metrics_destroy(m);
+    remove(METRICS_FILE);
+}
+
+static void check_write_failure(tester *tst)
+{
+    metrics *m = metrics_new();
+    tester_assert(tst, !metrics_write(m, "/nonexistent/dir/octo.prom"),
+            "check_write_failure");
+    metrics_destroy(m);
+}
+
+void test_metrics(tester *tst)
+{
+    tester_new_group(tst, "test_metrics");
+    check_write(tst);
+    check_write_failure(tst);
+}
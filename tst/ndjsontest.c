@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ndjsontest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ndjsontest.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "ndjson.h"
+
+#define OUTPUT_FILE "/tmp/octo_ndjsontest.json"
+
+static void init_result(struct proc_result *r)
+{
+    memset(r, 0, sizeof(*r));
+    r->action = PULL;
+    r->path = "/tmp";
+    r->project = "a";
+    r->project_path = "/tmp/a";
+    r->dirty = 1;
+    r->ahead = 2;
+    r->behind = -1;
+    r->duration_ns = 1500000000LL;
+}
+
+/* Reads back what was written to the output file */
+static const char *read_output(int fd)
+{
+    static char content[4096];
+    ssize_t n = pread(fd, content, sizeof(content) - 1, 0);
+    content[n < 0 ? 0 : n] = '\0';
+    return content;
+}
+
+static void check_write_result(tester *tst)
+{
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ndjson *out = ndjson_new(fd);
+    struct proc_result r;
+    init_result(&r);
+    r.branch = "master";
+    r.output = "ok\n";
+    r.output_len = 3;
+    tester_assert(tst, ndjson_write_result(out, "w", &r), "check_write_result");
+    tester_assert(tst,
+            !strcmp(read_output(fd),
+                    "{\"workspace\":\"w\",\"project\":\"a\",\"path\":\"/tmp/a\","
+                    "\"action\":\"pull\",\"exit_code\":0,\"branch\":\"master\","
+                    "\"dirty\":true,\"ahead\":2,\"behind\":null,"
+                    "\"duration\":1.500000,\"output\":\"ok\\n\","
+                    "\"output_truncated\":false,\"error\":null}\n"),
+            "check_write_result - content");
+
+    /* The error the action failed with */
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    r.exit_code = 128;
+    r.error = "Failed to clone 'a'";
+    ndjson_write_result(out, "w", &r);
+    const char *content = read_output(fd);
+    tester_assert(tst,
+            strstr(content, "\"exit_code\":128,") != NULL &&
+                    strstr(content, ",\"error\":\"Failed to clone 'a'\"}\n"),
+            "check_write_result - error");
+
+    /* The records follow each other one per line */
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    init_result(&r);
+    r.dirty = -1;
+    ndjson_write_path(out, "/tmp/a");
+    ndjson_write_job(out, 3, "w", "b", "/tmp/b");
+    tester_assert(tst,
+            !strcmp(read_output(fd),
+                    "{\"path\":\"/tmp/a\"}\n"
+                    "{\"index\":3,\"workspace\":\"w\",\"project\":\"b\","
+                    "\"path\":\"/tmp/b\"}\n"),
+            "check_write_result - records");
+    ndjson_destroy(out);
+    close(fd);
+    remove(OUTPUT_FILE);
+}
+
+static void check_escape(tester *tst)
+{
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ndjson *out = ndjson_new(fd);
+    ndjson_write_path(out, "a\"b\\c\td\x1b[0m\xc3\xa9");
+    tester_assert(tst,
+            !strcmp(read_output(fd),
+                    "{\"path\":\"a\\\"b\\\\c\\td\\u001b[0m\xc3\xa9\"}\n"),
+            "check_escape");
+
+    /* A character cut by the truncation of the output is dropped */
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    struct proc_result r;
+    init_result(&r);
+    r.output = "x\xe2\x82";
+    r.output_len = 3;
+    r.output_truncated = true;
+    ndjson_write_result(out, "w", &r);
+    tester_assert(tst,
+            strstr(read_output(fd),
+                    "\"output\":\"x\",\"output_truncated\":true,") != NULL,
+            "check_escape - truncated");
+    ndjson_destroy(out);
+    close(fd);
+    remove(OUTPUT_FILE);
+}
+
+void test_ndjson(tester *tst)
+{
+    tester_new_group(tst, "test_ndjson");
+    check_write_result(tst);
+    check_escape(tst);
+}
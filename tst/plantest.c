@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * plantest.c
+ */
+
+#include "plantest.h"
+#include <stdio.h>
+#include <string.h>
+#include "logger.h"
+#include "plan.h"
+#include "universe.h"
+
+#define DEF_FILE "/tmp/octo_plantest"
+
+static void handle_error(void *inst, int err_code, const char *err_msg)
+{
+    (void)err_code; /* unused parameter */
+    (void)err_msg; /* unused parameter */
+    tester_assert(inst, false, "test_plan - error");
+}
+
+static universe *new_universe(tester *tst, logger *log)
+{
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs("projects { a b }\n"
+          "workspace w1 -> /tmp { c }\n"
+          "workspace w2 -> /var {}\n",
+            file);
+    fclose(file);
+    return universe_new(log, DEF_FILE, tst, handle_error);
+}
+
+static void check_compile(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    plan *p = plan_new(u, NULL);
+    tester_assert(tst, plan_get_size(p) == 5 &&
+                    plan_get_workspace_count(p) == 2,
+            "check_compile - size");
+    tester_assert(tst, plan_get_workspace(p, 2) == 0 &&
+                    !strcmp(plan_get_project(p, 2), "c") &&
+                    !strcmp(plan_get_project_path(p, 2), "/tmp/c"),
+            "check_compile - job");
+    tester_assert(tst, plan_get_workspace(p, 3) == 1 &&
+                    !strcmp(plan_get_workspace_name(p, 1), "w2") &&
+                    !strcmp(plan_get_workspace_path(p, 1), "/var") &&
+                    !strcmp(plan_get_project_path(p, 4), "/var/b"),
+            "check_compile - workspace");
+    plan_destroy(p);
+    universe_destroy(u);
+    logger_destroy(log);
+}
+
+static void check_workspace_filter(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    plan *p = plan_new(u, "w2");
+    tester_assert(tst, plan_get_size(p) == 2 &&
+                    plan_get_workspace_count(p) == 1 &&
+                    plan_get_workspace(p, 1) == 0 &&
+                    !strcmp(plan_get_project_path(p, 1), "/var/b"),
+            "check_workspace_filter");
+    plan_destroy(p);
+    p = plan_new(u, "w3");
+    tester_assert(tst, plan_get_size(p) == 0 &&
+                    plan_get_workspace_count(p) == 0,
+            "check_workspace_filter - unknown");
+    plan_destroy(p);
+    universe_destroy(u);
+    logger_destroy(log);
+    remove(DEF_FILE);
+}
+
+/* Keeps the jobs of the projects named in the string */
+static bool keep_named(void *inst, plan *p, int job)
+{
+    return strstr(inst, plan_get_project(p, job)) != NULL;
+}
+
+static void check_retain(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    plan *p = plan_new(u, NULL);
+    plan_retain(p, "b", keep_named);
+    tester_assert(tst, plan_get_size(p) == 2 &&
+                    plan_get_workspace_count(p) == 2 &&
+                    !strcmp(plan_get_project_path(p, 0), "/tmp/b") &&
+                    plan_get_workspace(p, 1) == 1 &&
+                    !strcmp(plan_get_project_path(p, 1), "/var/b"),
+            "check_retain");
+    plan_destroy(p);
+    /* Workspaces left without jobs are dropped */
+    p = plan_new(u, NULL);
+    plan_retain(p, "a", keep_named);
+    plan_retain(p, "", keep_named);
+    tester_assert(tst, plan_get_size(p) == 0 &&
+                    plan_get_workspace_count(p) == 0,
+            "check_retain - none");
+    plan_destroy(p);
+    p = plan_new(u, NULL);
+    plan_retain(p, "c", keep_named);
+    tester_assert(tst, plan_get_size(p) == 1 &&
+                    plan_get_workspace_count(p) == 1 &&
+                    !strcmp(plan_get_workspace_name(p, 0), "w1"),
+            "check_retain - workspace");
+    plan_destroy(p);
+    universe_destroy(u);
+    logger_destroy(log);
+    remove(DEF_FILE);
+}
+
+void test_plan(tester *tst)
+{
+    tester_new_group(tst, "test_plan");
+    check_compile(tst);
+    check_workspace_filter(tst);
+    check_retain(tst);
+}
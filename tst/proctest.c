@@ -29,9 +29,16 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "proctest.h"
 
+#include <fcntl.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "config.h"
 #include "logger.h"
 #include "proc.h"
@@ -58,6 +65,13 @@ static void check_parse_cmd_line(tester *tst)
     tester_assert(tst, proc_parse_cmd_line(git, 2, s), "check_parse_cmd_line");
     tester_assert(tst, proc_get_action(git) == PULL, "check_parse_cmd_line");
 
+    char *p[] = {"octo", "plan"};
+    config_parse_cmd_line(config, 2, p);
+    tester_assert(tst,
+            proc_parse_cmd_line(git, 2, p) && proc_get_action(git) == PLAN &&
+                    !proc_is_repetitive(git),
+            "check_parse_cmd_line - plan");
+
     config_destroy(config);
     proc_destroy(git);
     logger_destroy(logger);
@@ -73,6 +87,159 @@ static void check_is_installed(tester *tst)
     tester_assert(tst, proc_is_git_installed(), __func__);
 }
 
+/*
+ * Returns the number of heap allocations made by dispatching the action once
+ * it has been warmed up.
+ */
+static long count_dispatch_allocs(proc *git)
+{
+    proc_action(git, "/", "tmp", "/tmp");
+    long allocs = tester_alloc_count();
+    proc_action(git, "/", "tmp", "/tmp");
+    return tester_alloc_count() - allocs;
+}
+
+static void check_dispatch_allocs(tester *tst)
+{
+    if (tester_alloc_count() < 0)
+        return;
+    logger *logger = logger_create(-1, stdout);
+    config *config = config_new();
+    proc *git = proc_new(logger, config);
+
+    char *exec[] = {"octo", "exec", "true"};
+    config_parse_cmd_line(config, 3, exec);
+    proc_parse_cmd_line(git, 3, exec);
+    tester_assert(tst, !count_dispatch_allocs(git), "check_dispatch_allocs");
+
+    /* Listing prints out the paths, so send them nowhere */
+    char *list[] = {"octo", "list"};
+    proc_parse_cmd_line(git, 2, list);
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    long allocs = count_dispatch_allocs(git);
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(null);
+    close(out);
+    tester_assert(tst, !allocs, "check_dispatch_allocs - list");
+
+    proc_destroy(git);
+    config_destroy(config);
+    logger_destroy(logger);
+}
+
+static void check_record(tester *tst)
+{
+    logger *logger = logger_create(-1, stdout);
+    config *config = config_new();
+    proc *git = proc_new(logger, config);
+    char *status[] = {"octo", "--no-colour", "status"};
+    config_parse_cmd_line(config, 3, status);
+    proc_parse_cmd_line(git, 3, status);
+
+    /* The status of a directory that is not a repository */
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    int fd = open("/tmp/octo_proctest", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    proc_action(git, "/", "tmp", "/tmp");
+    dup2(out, STDOUT_FILENO);
+    close(out);
+    char record[64];
+    ssize_t n = pread(fd, record, sizeof(record) - 1, 0);
+    record[n < 0 ? 0 : n] = 0;
+    close(fd);
+    remove("/tmp/octo_proctest");
+    tester_assert(tst, !strcmp(record, " · Found tmp {???}\n"),
+            "check_record");
+
+    proc_destroy(git);
+    config_destroy(config);
+    logger_destroy(logger);
+}
+
+#define SYNC_DIR "/tmp/octo_synctest"
+#define GIT_COMMIT "git -c user.name=t -c user.email=t@t commit -q --allow-empty"
+
+struct sync_result {
+    int exit_code;
+    char error[256];
+};
+
+static void record_sync_result(void *inst, const struct proc_result *result)
+{
+    struct sync_result *sync_result = inst;
+    sync_result->exit_code = result->exit_code;
+    snprintf(sync_result->error, sizeof(sync_result->error), "%s",
+            result->error ? result->error : "");
+}
+
+/*
+ * Syncs the project with its output sent nowhere and returns the exit code,
+ * keeping the error in the specified result.
+ */
+static int sync_project(
+        proc *git, const char *project, struct sync_result *sync_result)
+{
+    char project_path[256];
+    snprintf(project_path, sizeof(project_path), SYNC_DIR "/w/%s", project);
+    sync_result->exit_code = -1;
+    proc_set_result_handler(git, sync_result, record_sync_result);
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    proc_action(git, SYNC_DIR "/w", project, project_path);
+    dup2(out, STDOUT_FILENO);
+    close(null);
+    close(out);
+    return sync_result->exit_code;
+}
+
+static void check_sync(tester *tst)
+{
+    if (system("rm -rf " SYNC_DIR " && mkdir -p " SYNC_DIR "/w && "
+               "git init -q " SYNC_DIR "/origin/a && cd " SYNC_DIR
+               "/origin/a && " GIT_COMMIT " -m first"))
+        return;
+    logger *logger = logger_create(-1, stdout);
+    config *config = config_new();
+    proc *git = proc_new(logger, config);
+    struct sync_result result;
+    char *sync[] = {"octo", "sync", "file://" SYNC_DIR "/origin/"};
+    config_parse_cmd_line(config, 3, sync);
+    tester_assert(tst,
+            proc_parse_cmd_line(git, 3, sync) && proc_get_action(git) == SYNC,
+            "check_sync - parse");
+
+    /* The missing project is cloned and the existing one fast-forwarded */
+    tester_assert(tst,
+            !sync_project(git, "a", &result) &&
+                    !access(SYNC_DIR "/w/a/.git", F_OK),
+            "check_sync - clone");
+    tester_assert(tst,
+            !system("cd " SYNC_DIR "/origin/a && " GIT_COMMIT " -m second") &&
+                    !sync_project(git, "a", &result) &&
+                    !system("test \"$(git -C " SYNC_DIR "/w/a log -1 "
+                            "--format=%s)\" = second"),
+            "check_sync - pull");
+    tester_assert(tst, sync_project(git, "b", &result), "check_sync - failed");
+    tester_assert(tst,
+            !system("touch " SYNC_DIR "/w/c") &&
+                    sync_project(git, "c", &result) &&
+                    strstr(result.error, "is not a directory"),
+            "check_sync - not a directory");
+
+    proc_destroy(git);
+    config_destroy(config);
+    logger_destroy(logger);
+    if (system("rm -rf " SYNC_DIR))
+        return;
+}
+
 void test_proc(tester *tst)
 {
     tester_new_group(tst, "test_git");
@@ -80,4 +247,7 @@ void test_proc(tester *tst)
     check_parse_cmd_line(tst);
     check_null_logger(tst);
     check_is_installed(tst);
+    check_dispatch_allocs(tst);
+    check_record(tst);
+    check_sync(tst);
 }
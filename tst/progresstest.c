@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * progresstest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "progresstest.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "progress.h"
+
+#define OUTPUT_FILE "/tmp/octo_progresstest"
+#define SECOND 1000000000LL
+
+/* Reads back what was written to the output file */
+static const char *read_output(int fd)
+{
+    static char content[4096];
+    ssize_t n = pread(fd, content, sizeof(content) - 1, 0);
+    content[n < 0 ? 0 : n] = '\0';
+    return content;
+}
+
+static void check_render(tester *tst)
+{
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    progress *p = progress_new(fd, 3, 2);
+    progress_expect(p, 0, 4 * SECOND);
+    progress_start(p, 0, "w/a", SECOND);
+    progress_start(p, 1, "w/b", SECOND);
+    tester_assert(tst, progress_refresh(p, 2 * SECOND) == 100,
+            "check_render - frame");
+    /* The job without history is expected to take the average, 4 s */
+    tester_assert(tst,
+            !strcmp(read_output(fd), "      1.0s  w/a\n"
+                                     "      1.0s  w/b\n"
+                                     "[0/3] ETA 5.0s\n"),
+            "check_render");
+
+    /* The display is not redrawn till the next frame */
+    progress_finish(p, 0, 3 * SECOND);
+    progress_refresh(p, 2 * SECOND + SECOND / 20);
+    tester_assert(tst, strlen(read_output(fd)) == 47,
+            "check_render - throttled");
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    progress_write(p, "done a\n", 7);
+    tester_assert(tst, !strcmp(read_output(fd), "\033[3F\033[Jdone a\n"),
+            "check_render - write");
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    progress_refresh(p, 4 * SECOND);
+    tester_assert(tst,
+            !strcmp(read_output(fd), "      3.0s  w/b\n"
+                                     "[1/3] 0.3 jobs/s ETA 1.0s\n"),
+            "check_render - done");
+    progress_destroy(p);
+    close(fd);
+    remove(OUTPUT_FILE);
+}
+
+static void check_long_label(tester *tst)
+{
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    progress *p = progress_new(fd, 1, 1);
+    char label[200];
+    memset(label, 'x', sizeof(label) - 1);
+    label[sizeof(label) - 1] = 0;
+    progress_start(p, 0, label, 0);
+    progress_refresh(p, 0);
+    /* Lines are cut to the default width of 80 columns */
+    tester_assert(tst, strchr(read_output(fd), '\n') - read_output(fd) == 79,
+            "check_long_label");
+    progress_destroy(p);
+    close(fd);
+    remove(OUTPUT_FILE);
+}
+
+void test_progress(tester *tst)
+{
+    tester_new_group(tst, "test_progress");
+    check_render(tst);
+    check_long_label(tst);
+}
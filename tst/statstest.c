@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "statstest.h"
+#include <stdio.h>
+#include <string.h>
+#include "logger.h"
+#include "stats.h"
+
+#define DEF_FILE "/tmp/octo_statstest"
+
+static void add_entry(stats *s, const char *workspace, enum action action,
+        long long duration_ns, int exit_code)
+{
+    struct history_entry e;
+    e.action = action;
+    e.workspace = workspace;
+    e.project = "a";
+    e.exit_code = exit_code;
+    e.timestamp = 0;
+    e.duration_ns = duration_ns;
+    e.bytes = 100;
+    stats_add(s, &e);
+}
+
+static void handle_error(void *inst, int err_code, const char *err_msg)
+{
+    (void)err_code; /* unused parameter */
+    (void)err_msg; /* unused parameter */
+    tester_assert(inst, false, "test_stats - universe");
+}
+
+static universe *new_universe(tester *tst, logger *log)
+{
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs("projects { a }\nworkspace w1 -> /tmp {}\n", file);
+    fclose(file);
+    return universe_new(log, DEF_FILE, tst, handle_error);
+}
+
+static void check_percentiles(tester *tst, universe *u)
+{
+    struct stats_summary summary;
+    stats *s = stats_new(u, NULL, UNKNOWN);
+    /* 1..100 ms, getting slower */
+    for (int i = 1; i <= 100; i++)
+        add_entry(s, "w1", PULL, i * 1000000LL, i % 10 == 0);
+    tester_assert(tst, stats_get(s, "w1", "a", PULL, &summary),
+            "check_percentiles - get");
+    tester_assert(tst, summary.runs == 100 && summary.failures == 10,
+            "check_percentiles - runs");
+    tester_assert(tst,
+            summary.p50_ns == 50000000LL && summary.p95_ns == 95000000LL &&
+                    summary.p99_ns == 99000000LL,
+            "check_percentiles - percentiles");
+    tester_assert(tst, summary.bytes == 100, "check_percentiles - bytes");
+    tester_assert(tst, summary.has_trend && summary.trend > 0,
+            "check_percentiles - trend");
+    tester_assert(tst, !stats_get(s, "w1", "a", PUSH, &summary),
+            "check_percentiles - missing");
+    stats_destroy(s);
+}
+
+static void check_filters(tester *tst, universe *u)
+{
+    struct stats_summary summary;
+    stats *s = stats_new(u, "w1", PUSH);
+    add_entry(s, "w1", PUSH, 1, 0);
+    add_entry(s, "w1", PULL, 1, 0);
+    add_entry(s, "w2", PUSH, 1, 0);
+    tester_assert(tst, stats_get(s, "w1", "a", PUSH, &summary) &&
+                    summary.runs == 1 && !summary.has_trend,
+            "check_filters - matched");
+    tester_assert(tst, !stats_get(s, "w1", "a", PULL, &summary),
+            "check_filters - action");
+    tester_assert(tst, !stats_get(s, "w2", "a", PUSH, &summary),
+            "check_filters - workspace");
+    stats_destroy(s);
+
+    /* Workspaces no longer defined are skipped */
+    s = stats_new(u, NULL, UNKNOWN);
+    add_entry(s, "w2", PUSH, 1, 0);
+    tester_assert(tst, !stats_get(s, "w2", "a", PUSH, &summary),
+            "check_filters - undefined workspace");
+    stats_destroy(s);
+}
+
+void test_stats(tester *tst)
+{
+    tester_new_group(tst, "test_stats");
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    check_percentiles(tst, u);
+    check_filters(tst, u);
+    universe_destroy(u);
+    logger_destroy(log);
+    remove(DEF_FILE);
+}
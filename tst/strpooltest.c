@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * strpooltest.c
+ */
+
+#include "strpooltest.h"
+#include <stdio.h>
+#include <string.h>
+#include "strpool.h"
+
+static void check_intern(tester *tst)
+{
+    str_pool *pool = str_pool_new();
+    char buf[] = "apple";
+    const char *apple = str_pool_intern(pool, buf);
+    tester_assert(tst, apple != buf && !strcmp(apple, "apple"),
+            "check_intern - copy");
+    buf[0] = 'A';
+    tester_assert(tst, !strcmp(apple, "apple"), "check_intern - immutable");
+    tester_assert(tst, str_pool_intern(pool, "apple") == apple,
+            "check_intern - same");
+    tester_assert(tst, str_pool_intern(pool, "banana") != apple,
+            "check_intern - distinct");
+    tester_assert(tst, str_pool_intern_n(pool, "apples", 5) == apple,
+            "check_intern - prefix");
+    tester_assert(tst, str_pool_get_size(pool) == 2, "check_intern - size");
+    str_pool_destroy(pool);
+}
+
+static void check_many(tester *tst)
+{
+    str_pool *pool = str_pool_new();
+    const char *first[1000];
+    char buf[16];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(buf, "project%d", i);
+        first[i] = str_pool_intern(pool, buf);
+    }
+    bool ok = str_pool_get_size(pool) == 1000;
+    for (int i = 0; i < 1000 && ok; i++) {
+        sprintf(buf, "project%d", i);
+        ok = str_pool_intern(pool, buf) == first[i] && !strcmp(first[i], buf);
+    }
+    tester_assert(tst, ok, "check_many");
+    str_pool_destroy(pool);
+}
+
+static void check_long(tester *tst)
+{
+    str_pool *pool = str_pool_new();
+    static char big[10000];
+    memset(big, 'x', sizeof(big) - 1);
+    const char *small = str_pool_intern(pool, "small");
+    const char *s = str_pool_intern(pool, big);
+    tester_assert(tst, s && strlen(s) == sizeof(big) - 1, "check_long");
+    tester_assert(tst, str_pool_intern(pool, big) == s, "check_long - same");
+    /* The block being filled is kept after a long string is added */
+    const char *next = str_pool_intern(pool, "next");
+    tester_assert(tst, next == small + sizeof("small"), "check_long - next");
+    str_pool_destroy(pool);
+}
+
+static void check_allocs(tester *tst)
+{
+    str_pool *pool = str_pool_new();
+    str_pool_intern(pool, "warm up");
+    long allocs = tester_alloc_count();
+    for (int i = 0; i < 100; i++)
+        str_pool_intern(pool, "warm up");
+    if (allocs >= 0)
+        tester_assert(tst, tester_alloc_count() == allocs, "check_allocs");
+    str_pool_destroy(pool);
+}
+
+void test_str_pool(tester *tst)
+{
+    tester_new_group(tst, "test_str_pool");
+    check_intern(tst);
+    check_many(tst);
+    check_long(tst);
+    check_allocs(tst);
+}
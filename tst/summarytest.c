@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * summarytest.c
+ */
+
+#include "summarytest.h"
+#include <stdio.h>
+#include <string.h>
+#include "summary.h"
+
+#define OUTPUT_FILE "/tmp/octo_summarytest"
+
+static void init_result(struct proc_result *r, const char *project,
+        int exit_code, const char *output, const char *error)
+{
+    memset(r, 0, sizeof(*r));
+    r->action = CLONE;
+    r->project = project;
+    r->exit_code = exit_code;
+    r->output = output;
+    r->output_len = output ? strlen(output) : 0;
+    r->error = error;
+}
+
+/* Prints out the summary and reads it back */
+static const char *print_summary(summary *s)
+{
+    static char content[4096];
+    FILE *file = fopen(OUTPUT_FILE, "w+");
+    summary_print(s, file);
+    rewind(file);
+    size_t n = fread(content, 1, sizeof(content) - 1, file);
+    content[n] = '\0';
+    fclose(file);
+    remove(OUTPUT_FILE);
+    return content;
+}
+
+static void check_summary(tester *tst)
+{
+    summary *s = summary_new();
+    struct proc_result r;
+    init_result(&r, "a", 0, "Already up to date.\n", NULL);
+    summary_add(s, "w", &r);
+    tester_assert(tst, !summary_get_failures(s) && !*print_summary(s),
+            "check_summary - none");
+
+    /* The line Git reported the error on is preferred */
+    init_result(&r, "bb", 128,
+            "Cloning into 'bb'...\nfatal: repository not found\n",
+            "Failed to clone 'bb'");
+    summary_add(s, "w", &r);
+    init_result(&r, "c", -1, NULL, "Invalid project name");
+    summary_add(s, "workspace", &r);
+    init_result(&r, "d", 1, "\nerror: no upstream\r\n", NULL);
+    summary_add(s, "w", &r);
+    init_result(&r, "e", 1, "\nconflict\n", NULL);
+    summary_add(s, "w", &r);
+    tester_assert(tst, summary_get_failures(s) == 4, "check_summary");
+    tester_assert(tst,
+            !strcmp(print_summary(s),
+                    "Failed on 4 of 5 projects:\n"
+                    "WORKSPACE  PROJECT  EXIT  ERROR\n"
+                    "w          bb        128  fatal: repository not found\n"
+                    "workspace  c          -1  Invalid project name\n"
+                    "w          d           1  error: no upstream\n"
+                    "w          e           1  conflict\n"),
+            "check_summary - print");
+    summary_destroy(s);
+}
+
+void test_summary(tester *tst)
+{
+    tester_new_group(tst, "test_summary");
+    check_summary(tst);
+}
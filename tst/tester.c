@@ -29,10 +29,21 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "tester.h"
+#include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include "alloctrace.h"
+
+/* Maximum number of measured samples per benchmark */
+#define BENCH_SAMPLES 5
+/* Time budget for the measured samples of a single benchmark */
+#define BENCH_BUDGET_NS 2000000000LL
 
 const char *passed = "PASSED";
 const char *failed = "FAILED";
@@ -43,10 +54,53 @@ struct tester_s {
     int failures;
     bool only_failures;
     bool reported_results;
+    FILE *bench_file;
+    bool bench_header;
 };
 
 static void print_hline();
 
+#ifdef TESTER_WRAP_ALLOCS
+/*
+ * The test runner is linked with --wrap for the allocation functions so that
+ * every allocation made by the code under test lands here first.
+ */
+static long allocs;
+
+void *__real_malloc(size_t);
+void *__real_calloc(size_t, size_t);
+void *__real_realloc(void *, size_t);
+
+void *__wrap_malloc(size_t size)
+{
+    allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size)
+{
+    allocs++;
+    return __real_realloc(p, size);
+}
+#endif
+
+long tester_alloc_count()
+{
+#ifdef TESTER_WRAP_ALLOCS
+    return allocs;
+#elif defined(ALLOC_TRACE)
+    return alloc_trace_count();
+#else
+    return -1;
+#endif
+}
+
 tester *tester_create(bool only_failures)
 {
     tester *obj = (tester *)malloc(sizeof(tester));
@@ -91,9 +145,112 @@ bool tester_result(tester *obj)
     return obj->failures > 0;
 }
 
+void tester_set_bench_file(tester *obj, FILE *file)
+{
+    obj->bench_file = file;
+}
+
+/* Returns the monotonic clock reading in nanoseconds */
+static long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static long long run_sample(void (*fn)(void *, int), void *inst, int iterations)
+{
+    long long start = now_ns();
+    for (int i = 0; i < iterations; i++)
+        fn(inst, i);
+    return now_ns() - start;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Prints a benchmark line to the standard output and the bench file */
+static void print_bench(tester *obj, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    fflush(stdout);
+    if (obj->bench_file) {
+        va_start(args, fmt);
+        vfprintf(obj->bench_file, fmt, args);
+        va_end(args);
+    }
+}
+
+static void print_bench_header(tester *obj)
+{
+    if (!obj->bench_header) {
+        print_bench(obj, "%-36s %10s %12s %12s %12s %7s %10s\n", "# benchmark",
+                "ops", "ns/op", "min", "max", "rsd%", "allocs/op");
+        obj->bench_header = true;
+    }
+}
+
+void tester_bench_skip(tester *obj, const char *name)
+{
+    print_bench_header(obj);
+    print_bench(obj, "%-36s %10s\n", name, "skipped");
+}
+
+double tester_bench(tester *obj, const char *name, void (*fn)(void *, int),
+        void *inst, int iterations)
+{
+    double ns_per_op[BENCH_SAMPLES];
+    int samples = 0;
+
+    print_bench_header(obj);
+
+    /* Warm up; a sample that alone exhausts the budget is kept instead */
+    long allocs_before = tester_alloc_count();
+    long long elapsed = run_sample(fn, inst, iterations);
+    if (elapsed >= BENCH_BUDGET_NS) {
+        ns_per_op[samples++] = (double)elapsed / iterations;
+    } else {
+        allocs_before = tester_alloc_count();
+        long long deadline = now_ns() + BENCH_BUDGET_NS;
+        do {
+            elapsed = run_sample(fn, inst, iterations);
+            ns_per_op[samples++] = (double)elapsed / iterations;
+        } while (samples < BENCH_SAMPLES && now_ns() < deadline);
+    }
+    long allocs_after = tester_alloc_count();
+
+    /* Simple statistics over the samples */
+    double mean = 0, var = 0;
+    for (int i = 0; i < samples; i++)
+        mean += ns_per_op[i];
+    mean /= samples;
+    for (int i = 0; i < samples; i++)
+        var += (ns_per_op[i] - mean) * (ns_per_op[i] - mean);
+    double rsd = mean > 0 ? 100.0 * sqrt(var / samples) / mean : 0;
+    qsort(ns_per_op, samples, sizeof(double), compare_doubles);
+
+    print_bench(obj, "%-36s %10d %12.1f %12.1f %12.1f %7.1f ", name,
+            iterations, ns_per_op[samples / 2], ns_per_op[0],
+            ns_per_op[samples - 1], rsd);
+    if (allocs_before < 0)
+        print_bench(obj, "%10s\n", "-");
+    else
+        print_bench(obj, "%10.2f\n",
+                (double)(allocs_after - allocs_before) /
+                        ((double)samples * iterations));
+    return ns_per_op[samples / 2];
+}
+
 void tester_destroy(tester *obj)
 {
-    if (!obj->reported_results)
+    /* A benchmark-only run has no test results to report */
+    if (!obj->reported_results && obj->groups)
         tester_result(obj);
     free(obj);
 }
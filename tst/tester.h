@@ -33,6 +33,7 @@
 #define TESTER_H
 
 #include <stdbool.h>
+#include <stdio.h>
 
 typedef struct tester_s tester;
 
@@ -42,4 +43,29 @@ void tester_assert(tester *, bool, const char *);
 bool tester_result(tester *);
 void tester_destroy(tester *);
 
+/*
+ * Directs the benchmark results to the specified file in addition to the
+ * standard output. The file is not closed by the tester.
+ */
+void tester_set_bench_file(tester *, FILE *);
+
+/*
+ * Benchmarks the specified function. The function is called with the given
+ * instance and the operation index for each of the iterations in a sample.
+ * The first sample warms up the caches and is discarded. Returns the median
+ * time per operation in nanoseconds.
+ */
+double tester_bench(tester *, const char *, void (*)(void *, int), void *, int);
+
+/*
+ * Records the specified benchmark as skipped.
+ */
+void tester_bench_skip(tester *, const char *);
+
+/*
+ * Returns the number of heap allocations made so far or -1 if allocation
+ * counting is not supported by this build.
+ */
+long tester_alloc_count();
+
 #endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ucachetest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ucachetest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "ucache.h"
+
+#define DEF_FILE "/tmp/octo_ucachetest"
+#define CACHE_FILE DEF_FILE ".cache"
+
+static const char *DEFS = "projects { a b }\n";
+
+static const char *const W1_PROJECTS[] = {"a", "b", "c"};
+static const char *const W2_PROJECTS[] = {"a", "b"};
+
+static const struct ucache_workspace WORKSPACES[] = {
+        {"w1", "/tmp", W1_PROJECTS, 3}, {"w2", "/var", W2_PROJECTS, 2}};
+
+/*
+ * Writes the definition file and its image. The image does not have to
+ * match the definitions as far as the cache is concerned.
+ */
+static bool write_files(const char *defs)
+{
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs(defs, file);
+    fclose(file);
+    struct stat st;
+    stat(DEF_FILE, &st);
+    struct ucache_source source;
+    source.size = st.st_size;
+    source.mtime_ns = ucache_mtime_ns(&st);
+    source.hash = ucache_hash(defs, strlen(defs));
+    return ucache_write(DEF_FILE, &source, WORKSPACES, 2);
+}
+
+static void check_file_name(tester *tst)
+{
+    char *name = ucache_file_name("/tmp/workspaces");
+    tester_assert(tst, !strcmp(name, "/tmp/workspaces.cache"),
+            "check_file_name");
+    free(name);
+}
+
+static void check_round_trip(tester *tst)
+{
+    tester_assert(tst, write_files(DEFS), "check_round_trip - write");
+    ucache *cache = ucache_open(DEF_FILE);
+    tester_assert(tst, cache, "check_round_trip - open");
+    if (!cache)
+        return;
+    tester_assert(tst, ucache_get_workspace_count(cache) == 2 &&
+                    !strcmp(ucache_get_workspace_name(cache, 1), "w2") &&
+                    !strcmp(ucache_get_workspace_path(cache, 1), "/var"),
+            "check_round_trip - workspaces");
+    tester_assert(tst, ucache_get_project_count(cache, 0) == 3 &&
+                    !strcmp(ucache_get_project(cache, 0, 2), "c") &&
+                    ucache_get_project(cache, 0, 0) ==
+                            ucache_get_project(cache, 1, 0),
+            "check_round_trip - projects");
+    tester_assert(tst, ucache_find_workspace(cache, "w1") == 0 &&
+                    ucache_find_workspace(cache, "w2") == 1 &&
+                    ucache_find_workspace(cache, "w3") == -1,
+            "check_round_trip - find");
+    ucache_close(cache);
+}
+
+static void check_stale(tester *tst)
+{
+    write_files(DEFS);
+    FILE *file = fopen(DEF_FILE, "a");
+    fputs("workspace w3 -> /opt {}\n", file);
+    fclose(file);
+    ucache *cache = ucache_open(DEF_FILE);
+    tester_assert(tst, !cache, "check_stale");
+    if (cache)
+        ucache_close(cache);
+}
+
+/* A definition file touched without being changed is recognised by hash */
+static void check_touched(tester *tst)
+{
+    write_files(DEFS);
+    struct timespec times[2] = {{0, UTIME_OMIT}, {1000000000, 0}};
+    utimensat(0, DEF_FILE, times, 0);
+    ucache *cache = ucache_open(DEF_FILE);
+    tester_assert(tst, cache, "check_touched");
+    if (cache)
+        ucache_close(cache);
+
+    /* A change of the same size is not */
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs("projects { c d }\n", file);
+    fclose(file);
+    times[1].tv_sec++;
+    utimensat(0, DEF_FILE, times, 0);
+    cache = ucache_open(DEF_FILE);
+    tester_assert(tst, !cache, "check_touched - changed");
+    if (cache)
+        ucache_close(cache);
+}
+
+static void check_corrupt(tester *tst)
+{
+    write_files(DEFS);
+    FILE *file = fopen(CACHE_FILE, "r+");
+    fseek(file, 48, SEEK_SET);
+    fputc(0x7F, file);
+    fclose(file);
+    ucache *cache = ucache_open(DEF_FILE);
+    tester_assert(tst, !cache, "check_corrupt");
+    if (cache)
+        ucache_close(cache);
+
+    file = fopen(CACHE_FILE, "w");
+    fputs("OCTOUC01", file);
+    fclose(file);
+    cache = ucache_open(DEF_FILE);
+    tester_assert(tst, !cache, "check_corrupt - truncated");
+    if (cache)
+        ucache_close(cache);
+    remove(CACHE_FILE);
+    remove(DEF_FILE);
+}
+
+void test_ucache(tester *tst)
+{
+    tester_new_group(tst, "test_ucache");
+    check_file_name(tst);
+    check_round_trip(tst);
+    check_stale(tst);
+    check_touched(tst);
+    check_corrupt(tst);
+}
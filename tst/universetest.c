@@ -28,15 +28,246 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+
+#define _POSIX_C_SOURCE 200809L
+
 #include "universetest.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "logger.h"
+#include "universe.h"
+
+#define DEF_FILE "/tmp/octo_universetest"
+#define DEF_FIFO "/tmp/octo_universetest_fifo"
+
+/* The declarations written to the definition file */
+static const char *DEFS = "projects { a b c }\n"
+                          "workspace w1 -> /tmp { d }\n"
+                          "workspace w2 -> /var {}\n";
+
+static void handle_error(void *inst, int err_code, const char *err_msg)
+{
+    (void)err_code; /* unused parameter */
+    (void)err_msg; /* unused parameter */
+    tester_assert(inst, false, "test_universe - error");
+}
+
+static universe *new_universe(tester *tst, logger *log)
+{
+    FILE *file = fopen(DEF_FILE, "w");
+    fputs(DEFS, file);
+    fclose(file);
+    return universe_new(log, DEF_FILE, tst, handle_error);
+}
+
+static void count_visit(
+        void *inst, const char *name, const char *path, const char *project)
+{
+    (void)name; /* unused parameter */
+    (void)path; /* unused parameter */
+    (void)project; /* unused parameter */
+    (*(int *)inst)++;
+}
+
+struct first_project {
+    const char *w1;
+    const char *w2;
+};
+
+static void find_first_project(
+        void *inst, const char *name, const char *path, const char *project)
+{
+    (void)path; /* unused parameter */
+    struct first_project *first = inst;
+    if (!strcmp(project, "a")) {
+        if (!strcmp(name, "w1"))
+            first->w1 = project;
+        else
+            first->w2 = project;
+    }
+}
+
+/* The default projects are shared by the workspaces rather than copied */
+static void check_interning(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    struct first_project first = {NULL, NULL};
+    universe_accept(u, &first, find_first_project);
+    tester_assert(tst, first.w1 && first.w1 == first.w2, "check_interning");
+    universe_destroy(u);
+    logger_destroy(log);
+}
 
 static void check_construction(tester *tst)
 {
-    (void)tst;
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    const char *path = universe_get_workspace_path(u, "w2");
+    tester_assert(tst, path && !strcmp(path, "/var"), "check_construction");
+    tester_assert(tst, !universe_get_workspace_path(u, "w3"),
+            "check_construction - unknown");
+    universe_destroy(u);
+    logger_destroy(log);
+}
+
+/* Mapping the definition file and interning the names takes few blocks */
+static void check_construction_allocs(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    long allocs = tester_alloc_count();
+    universe *u = new_universe(tst, log);
+    if (allocs >= 0)
+        tester_assert(tst, tester_alloc_count() - allocs < 32,
+                "check_construction_allocs");
+    universe_destroy(u);
+    logger_destroy(log);
+}
+
+/* Definitions that cannot be mapped are read through stdio */
+static void check_fifo(tester *tst)
+{
+    remove(DEF_FIFO);
+    if (mkfifo(DEF_FIFO, 0600))
+        return;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (!pid) {
+        FILE *file = fopen(DEF_FIFO, "w");
+        if (file) {
+            fputs(DEFS, file);
+            fclose(file);
+        }
+        _exit(0);
+    }
+    logger *log = logger_create(-1, stdout);
+    universe *u = universe_new(log, DEF_FIFO, tst, handle_error);
+    int visits = 0;
+    universe_accept(u, &visits, count_visit);
+    tester_assert(tst, visits == 7, "check_fifo");
+    universe_destroy(u);
+    logger_destroy(log);
+    waitpid(pid, NULL, 0);
+    remove(DEF_FIFO);
+}
+
+/* A universe read from the image looks the same as a parsed one */
+static void check_cached(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    new_universe(tst, log);
+    remove(DEF_FILE ".cache");
+    bool ok = true;
+    for (int i = 0; i < 3; i++) {
+        /* Parsed and cached, read from the image, rebuilt */
+        struct universe_options options = {true, i == 2, NULL, false};
+        universe *u = universe_new_ex(log, DEF_FILE, &options, tst,
+                handle_error);
+        int visits = 0;
+        universe_accept(u, &visits, count_visit);
+        struct first_project first = {NULL, NULL};
+        universe_accept(u, &first, find_first_project);
+        const char *path = universe_get_workspace_path(u, "w2");
+        ok = ok && visits == 7 && first.w1 && first.w1 == first.w2 && path &&
+                !strcmp(path, "/var") && !universe_get_workspace_path(u, "w3");
+        universe_destroy(u);
+        FILE *cache = fopen(DEF_FILE ".cache", "r");
+        ok = ok && cache;
+        if (cache)
+            fclose(cache);
+    }
+    tester_assert(tst, ok, "check_cached");
+    remove(DEF_FILE ".cache");
+    logger_destroy(log);
+}
+
+/* Only the requested workspace is materialised, with or without the image */
+static void check_selective(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    new_universe(tst, log);
+    remove(DEF_FILE ".cache");
+    struct universe_options all = {true, false, NULL, false};
+    bool ok = true;
+    for (int i = 0; i < 2; i++) {
+        /* Parsed, then read from the image written by a complete run */
+        if (i)
+            universe_destroy(
+                    universe_new_ex(log, DEF_FILE, &all, tst, handle_error));
+        struct universe_options options = {true, false, "w1", false};
+        universe *u = universe_new_ex(log, DEF_FILE, &options, tst,
+                handle_error);
+        int visits = 0;
+        universe_accept(u, &visits, count_visit);
+        ok = ok && visits == 4 && universe_get_workspace_path(u, "w1") &&
+                !universe_get_workspace_path(u, "w2");
+        universe_destroy(u);
+        FILE *cache = fopen(DEF_FILE ".cache", "r");
+        ok = ok && (cache != NULL) == (i == 1);
+        if (cache)
+            fclose(cache);
+    }
+    tester_assert(tst, ok, "check_selective");
+    remove(DEF_FILE ".cache");
+
+    struct universe_options options = {false, false, "w2", true};
+    universe *u = universe_new_ex(log, DEF_FILE, &options, tst, handle_error);
+    const char *path = universe_get_workspace_path(u, "w2");
+    tester_assert(tst, path && !strcmp(path, "/var"),
+            "check_selective - path");
+    universe_destroy(u);
+    logger_destroy(log);
+}
+
+/* An unknown workspace selects nothing from the image */
+static void check_unknown_workspace(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    new_universe(tst, log);
+    remove(DEF_FILE ".cache");
+    struct universe_options all = {true, false, NULL, false};
+    universe_destroy(universe_new_ex(log, DEF_FILE, &all, tst, handle_error));
+    struct universe_options options = {true, false, "nosuch", false};
+    universe *u = universe_new_ex(log, DEF_FILE, &options, tst, handle_error);
+    int visits = 0;
+    universe_accept(u, &visits, count_visit);
+    tester_assert(tst,
+            !visits && !universe_get_workspace_path(u, "nosuch"),
+            "check_unknown_workspace");
+    universe_destroy(u);
+    remove(DEF_FILE ".cache");
+    logger_destroy(log);
+}
+
+static void check_accept_allocs(tester *tst)
+{
+    logger *log = logger_create(-1, stdout);
+    universe *u = new_universe(tst, log);
+    int visits = 0;
+    universe_accept(u, &visits, count_visit);
+    tester_assert(tst, visits == 7, "check_accept_allocs - visits");
+    long allocs = tester_alloc_count();
+    universe_accept(u, &visits, count_visit);
+    if (allocs >= 0)
+        tester_assert(tst, tester_alloc_count() == allocs,
+                "check_accept_allocs");
+    universe_destroy(u);
+    logger_destroy(log);
+    remove(DEF_FILE);
 }
 
 void test_universe(tester *tst)
 {
     tester_new_group(tst, "test_universe");
     check_construction(tst);
+    check_interning(tst);
+    check_construction_allocs(tst);
+    check_fifo(tst);
+    check_cached(tst);
+    check_selective(tst);
+    check_unknown_workspace(tst);
+    check_accept_allocs(tst);
 }
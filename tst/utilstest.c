@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * utilstest.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "utilstest.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils.h"
+
+static void check_find_executable(tester *tst)
+{
+    char path[MAX_PATH];
+    char *prev_path = strdup(getenv("PATH") ? getenv("PATH") : "");
+    char cwd[MAX_PATH];
+    getcwd(cwd, sizeof(cwd));
+
+    setenv("PATH", "/nonexistent:/bin", 1);
+    tester_assert(tst,
+            find_executable("sh", path, MAX_PATH) && !strcmp(path, "/bin/sh"),
+            "check_find_executable");
+    tester_assert(tst, !find_executable("octo-nonexistent", path, MAX_PATH),
+            "check_find_executable - missing");
+    /* Directories and non-executable files do not count */
+    setenv("PATH", "/", 1);
+    tester_assert(tst, !find_executable("etc", path, MAX_PATH) &&
+                    !find_executable("etc/passwd", path, MAX_PATH),
+            "check_find_executable - not executable");
+    /* Relative entries are resolved against the current directory */
+    setenv("PATH", "bin", 1);
+    chdir("/");
+    tester_assert(tst,
+            find_executable("sh", path, MAX_PATH) && !strcmp(path, "/bin/sh"),
+            "check_find_executable - relative");
+    tester_assert(tst, !find_executable("sh", path, 4),
+            "check_find_executable - too long");
+    /* So are the empty entries, wherever they are in the list */
+    const char *empty_entries[] = {":/nonexistent", "/nonexistent::/usr",
+            "/nonexistent:", ""};
+    char bin[MAX_PATH - 3];
+    char sh[MAX_PATH];
+    chdir("/bin");
+    snprintf(sh, sizeof(sh), "%s/sh", getcwd(bin, sizeof(bin)) ? bin : "");
+    for (size_t i = 0; i < sizeof(empty_entries) / sizeof(char *); i++) {
+        setenv("PATH", empty_entries[i], 1);
+        tester_assert(tst,
+                find_executable("sh", path, MAX_PATH) && !strcmp(path, sh),
+                "check_find_executable - empty entry");
+    }
+
+    chdir(cwd);
+    setenv("PATH", prev_path, 1);
+    free(prev_path);
+}
+
+void test_utils(tester *tst)
+{
+    tester_new_group(tst, "test_utils");
+    check_find_executable(tst);
+}
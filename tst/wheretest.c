@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * wheretest.c
+ */
+
+#include "wheretest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "where.h"
+
+#define TEST_DIR "/tmp/octo_wheretest"
+
+static void check_syntax(tester *tst)
+{
+    const char *valid[] = {"dirty", "!clean", "not ahead && behind",
+            "name=a* and (workspace!=w || branch=feature/*)",
+            "((dirty))or(clean)", "name = a&&dirty", "name=[!x]y"};
+    const char *invalid[] = {"", "dirty &&", "(dirty", "dirty)", "foo",
+            "name", "name=", "name=(a)", "dirty clean", "!", "notdirty"};
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        const char *err_msg = NULL;
+        where *w = where_new(valid[i], &err_msg);
+        tester_assert(tst, w && !err_msg, "check_syntax - valid");
+        if (w)
+            where_destroy(w);
+    }
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        const char *err_msg = NULL;
+        where *w = where_new(invalid[i], &err_msg);
+        tester_assert(tst, !w && err_msg, "check_syntax - invalid");
+        if (w)
+            where_destroy(w);
+    }
+}
+
+static void check_names(tester *tst)
+{
+    const char *err_msg;
+    where *w = where_new("name=a* && workspace!=w2", &err_msg);
+    tester_assert(tst, where_match(w, "w1", "abc", "/tmp/abc") &&
+                    !where_match(w, "w2", "abc", "/tmp/abc") &&
+                    !where_match(w, "w1", "bc", "/tmp/bc"),
+            "check_names");
+    where_destroy(w);
+    w = where_new("not name=b || (workspace=w1)", &err_msg);
+    tester_assert(tst, where_match(w, "w2", "a", "/tmp/a") &&
+                    where_match(w, "w1", "b", "/tmp/b") &&
+                    !where_match(w, "w2", "b", "/tmp/b"),
+            "check_names - not");
+    tester_assert(tst, where_get_probe_count(w) == 0, "check_names - probes");
+    where_destroy(w);
+}
+
+static void write_file(const char *file_name, const char *content)
+{
+    FILE *file = fopen(file_name, "w");
+    fputs(content, file);
+    fclose(file);
+}
+
+static void check_branch(tester *tst)
+{
+    /* A work tree, a linked one and one with a detached HEAD */
+    mkdir(TEST_DIR, 0755);
+    mkdir(TEST_DIR "/a", 0755);
+    mkdir(TEST_DIR "/a/.git", 0755);
+    write_file(TEST_DIR "/a/.git/HEAD", "ref: refs/heads/feature/x\n");
+    mkdir(TEST_DIR "/b", 0755);
+    mkdir(TEST_DIR "/b/git", 0755);
+    write_file(TEST_DIR "/b/.git", "gitdir: git\n");
+    write_file(TEST_DIR "/b/git/HEAD", "ref: refs/heads/master\n");
+    mkdir(TEST_DIR "/c", 0755);
+    mkdir(TEST_DIR "/c/.git", 0755);
+    write_file(TEST_DIR "/c/.git/HEAD",
+            "0123456789abcdef0123456789abcdef01234567\n");
+
+    const char *err_msg;
+    where *w = where_new("branch=feature/*", &err_msg);
+    tester_assert(tst, where_match(w, "w", "a", TEST_DIR "/a") &&
+                    !where_match(w, "w", "b", TEST_DIR "/b"),
+            "check_branch");
+    where_destroy(w);
+    w = where_new("branch!=master", &err_msg);
+    tester_assert(tst, where_match(w, "w", "a", TEST_DIR "/a") &&
+                    !where_match(w, "w", "b", TEST_DIR "/b") &&
+                    where_match(w, "w", "c", TEST_DIR "/c"),
+            "check_branch - linked");
+    /* Without a HEAD the branch is unknown and neither comparison holds */
+    tester_assert(tst, !where_match(w, "w", "d", TEST_DIR "/d"),
+            "check_branch - unknown");
+    where_destroy(w);
+    w = where_new("branch=HEAD", &err_msg);
+    tester_assert(tst, where_match(w, "w", "c", TEST_DIR "/c") &&
+                    where_get_probe_count(w) == 0,
+            "check_branch - detached");
+    where_destroy(w);
+
+    remove(TEST_DIR "/a/.git/HEAD");
+    remove(TEST_DIR "/a/.git");
+    remove(TEST_DIR "/a");
+    remove(TEST_DIR "/b/git/HEAD");
+    remove(TEST_DIR "/b/git");
+    remove(TEST_DIR "/b/.git");
+    remove(TEST_DIR "/b");
+    remove(TEST_DIR "/c/.git/HEAD");
+    remove(TEST_DIR "/c/.git");
+    remove(TEST_DIR "/c");
+    remove(TEST_DIR);
+}
+
+static void check_pushdown(tester *tst)
+{
+    const char *err_msg;
+    /* The name is compared first, so Git does not run for other names */
+    where *w = where_new("(dirty || ahead) && name=a", &err_msg);
+    tester_assert(tst, !where_match(w, "w", "b", TEST_DIR "/b") &&
+                    where_get_probe_count(w) == 0,
+            "check_pushdown");
+    /* The probes fail outside a repository and run once per job */
+    tester_assert(tst, !where_match(w, "w", "a", TEST_DIR "/a") &&
+                    where_get_probe_count(w) == 2,
+            "check_pushdown - probes");
+    where_destroy(w);
+    w = where_new("dirty || clean || !dirty", &err_msg);
+    tester_assert(tst, where_match(w, "w", "a", TEST_DIR "/a") &&
+                    where_get_probe_count(w) == 1,
+            "check_pushdown - cached");
+    where_destroy(w);
+}
+
+void test_where(tester *tst)
+{
+    tester_new_group(tst, "test_where");
+    check_syntax(tst);
+    check_names(tst);
+    check_branch(tst);
+    check_pushdown(tst);
+}
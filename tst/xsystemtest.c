@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018-2026, Vlad Shurupov
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "xsystemtest.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "xsystem.h"
+
+#define OUTPUT_FILE "/tmp/octo_xsystemtest"
+
+/* Number of spawns per benchmark sample */
+#define BENCH_SPAWNS 100
+
+static const char *STRATEGIES[] = {
+        "popen", "fork", "vfork", "posix_spawn", "clone"};
+
+/* The git invocations octo makes for every repository */
+static const char *GIT_COMMANDS[][2] = {
+        {"rev-parse", "git rev-parse --abbrev-ref HEAD 2>&1"},
+        {"status", "git status --porcelain 2>&1"}};
+
+static void check_strategies(tester *tst)
+{
+    enum spawn_strategy strategy;
+    struct char_buffer *buff = char_buffer_new(64);
+    for (size_t i = 0; i < sizeof(STRATEGIES) / sizeof(char *); i++) {
+        if (!xsystem_parse_strategy(STRATEGIES[i], &strategy))
+            continue;
+        tester_assert(tst, !strcmp(STRATEGIES[i],
+                                   xsystem_strategy_name(strategy)),
+                "check_strategies - name");
+        char_buffer_reset(buff);
+        int result = xsystem_with(strategy, "echo hello", buff, false);
+        tester_assert(tst, !result, "check_strategies - result");
+        tester_assert(tst,
+                char_buffer_len(buff) == 6 &&
+                        !strncmp(buff->buffer + buff->position, "hello\n", 6),
+                "check_strategies - output");
+        char_buffer_reset(buff);
+        tester_assert(tst, xsystem_with(strategy, "exit 3", buff, false),
+                "check_strategies - failure");
+    }
+    tester_assert(tst, !xsystem_parse_strategy("teleport", &strategy),
+            "check_strategies - unknown");
+    char_buffer_destroy(buff);
+}
+
+static void check_truncation(tester *tst)
+{
+    struct char_buffer *buff = char_buffer_new(4);
+    int result = xsystem("echo truncated", buff, false);
+    tester_assert(tst, !result && char_buffer_len(buff) == 4 &&
+                    !strncmp(buff->buffer, "trun", 4),
+            "check_truncation");
+    char_buffer_destroy(buff);
+}
+
+/*
+ * Checks the output of the command is passed through to stdout in full and
+ * captured as far as it fits the buffer.
+ */
+static void check_pass_through(tester *tst)
+{
+    struct char_buffer *buff = char_buffer_new(16);
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    int fd = open(OUTPUT_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    long long bytes_read = xsystem_get_bytes_read();
+    int result = xsystem("seq 1 100000", buff, true);
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+    bytes_read = xsystem_get_bytes_read() - bytes_read;
+    tester_assert(tst, !result && char_buffer_len(buff) == 16 &&
+                    !strncmp(buff->buffer, "1\n2\n3\n4\n5\n6\n7\n8\n", 16),
+            "check_pass_through");
+    /* seq prints 588895 bytes in total */
+    char tail[16];
+    ssize_t n = pread(fd, tail, 8, 588895 - 8);
+    tail[n < 0 ? 0 : n] = 0;
+    tester_assert(tst, bytes_read == 588895 &&
+                    lseek(fd, 0, SEEK_END) == 588895 &&
+                    !strcmp(tail, "\n100000\n"),
+            "check_pass_through - output");
+    close(fd);
+    remove(OUTPUT_FILE);
+    char_buffer_destroy(buff);
+}
+
+struct spawn_bench {
+    enum spawn_strategy strategy;
+    const char *cmd;
+    struct char_buffer *buff;
+};
+
+static void bench_spawn(void *inst, int i)
+{
+    (void)i;
+    struct spawn_bench *b = inst;
+    char_buffer_reset(b->buff);
+    xsystem_with(b->strategy, b->cmd, b->buff, false);
+}
+
+static void bench_system(void *inst, int i)
+{
+    (void)i;
+    if (system(inst))
+        return;
+}
+
+void bench_xsystem(tester *tst)
+{
+    char name[64];
+    char cmd[128];
+    struct spawn_bench b;
+    b.buff = char_buffer_new(8192);
+    for (size_t c = 0; c < sizeof(GIT_COMMANDS) / sizeof(GIT_COMMANDS[0]);
+            c++) {
+        /* The reference point: no pipe and no output capture */
+        snprintf(cmd, sizeof(cmd), "%s >/dev/null", GIT_COMMANDS[c][1]);
+        snprintf(name, sizeof(name), "xsystem/%s/system", GIT_COMMANDS[c][0]);
+        tester_bench(tst, name, bench_system, cmd, BENCH_SPAWNS);
+        b.cmd = GIT_COMMANDS[c][1];
+        for (size_t i = 0; i < sizeof(STRATEGIES) / sizeof(char *); i++) {
+            snprintf(name, sizeof(name), "xsystem/%s/%s", GIT_COMMANDS[c][0],
+                    STRATEGIES[i]);
+            if (!xsystem_parse_strategy(STRATEGIES[i], &b.strategy)) {
+                tester_bench_skip(tst, name);
+                continue;
+            }
+            tester_bench(tst, name, bench_spawn, &b, BENCH_SPAWNS);
+        }
+    }
+    char_buffer_destroy(b.buff);
+}
+
+void test_xsystem(tester *tst)
+{
+    tester_new_group(tst, "test_xsystem");
+    check_strategies(tst);
+    check_truncation(tst);
+    check_pass_through(tst);
+}